@@ -16,6 +16,14 @@ using std::string;
 // using namespace wasm;
 #define SYMBOL(sym_code, precision) symbol(symbol_code(sym_code), precision)
 #define hash(str) sha256(const_cast<char*>(str.c_str()), str.size())
+
+//first 128 bits of sha256(str), used as the ads id index key
+inline uint128_t hash128(const string& str) {
+    auto digest = hash(str).extract_as_byte_array();
+    uint128_t key = 0;
+    for (size_t i = 0; i < sizeof(uint128_t); i++) key = (key << 8) | digest[i];
+    return key;
+}
 static constexpr symbol SYS_SYMBOL              = SYMBOL("AMAX", 8);
 static constexpr name APL_CONTRACT              { "aplink.token"_n };
 
@@ -31,6 +39,7 @@ static constexpr uint64_t HOUR_SECONDS           = HOUR_SECONDS_FOR_TEST;
 #endif//HOUR_SECONDS_FOR_TEST
 
 static constexpr uint32_t MAX_TITLE_SIZE        = 64;
+static constexpr uint32_t MAX_CONFIRM_BATCH     = 200;
 
 
 namespace wasm { namespace db {
@@ -60,11 +69,16 @@ struct CUSTODY_TBL ads_order_t {
 
     uint64_t primary_key() const { return id; }
     uint64_t by_miner() const { return miner.value; }
-    checksum256 by_ads_id() const { return hash(ads_id); }  //unique ads id
+    uint128_t by_ads_id() const { return hash128(ads_id); }  //unique ads id, truncated hash
+    uint64_t by_expiry() const { return expired_at.sec_since_epoch(); }
 
+    //orders written before the byexpiry index and the 128-bit adsidx key have no byexpiry entry and a
+    //checksum256 adsidx entry, so `sweepexpired` never visits them and erasing them leaves the old entry
+    //behind. Drain the table with `confirmads`/`onswapexpird` under the old code before upgrading.
     typedef eosio::multi_index<"adsorder"_n, ads_order_t,
         indexed_by<"mineridx"_n,  const_mem_fun<ads_order_t, uint64_t, &ads_order_t::by_miner> >,
-        indexed_by<"adsidx"_n,  const_mem_fun<ads_order_t, checksum256, &ads_order_t::by_ads_id> >
+        indexed_by<"adsidx"_n,  const_mem_fun<ads_order_t, uint128_t, &ads_order_t::by_ads_id> >,
+        indexed_by<"byexpiry"_n,  const_mem_fun<ads_order_t, uint64_t, &ads_order_t::by_expiry> >
     > tbl_t;
 
     EOSLIB_SERIALIZE( ads_order_t, (id)(miner)(ads_id)(recd_apls)(created_at)(expired_at) )
@@ -86,4 +100,23 @@ struct CUSTODY_TBL swap_conf_t {
                                     (mine_token_total)(mine_token_remained))
 };
 
+//snapshot of all swap confs in one row, sorted by swap_amount, it replaces the swapconfs table, see `migrateconfs`
+struct CUSTODY_TBL_NAME("swaptiers") swap_tiers_t {
+    vector<swap_conf_t> tiers;
+
+    EOSLIB_SERIALIZE( swap_tiers_t, (tiers) )
+};
+typedef eosio::singleton< "swaptiers"_n, swap_tiers_t > swap_tiers_singleton;
+
+//one processed order in an adsbatchlog
+struct ads_swap_log_t {
+    uint64_t        order_id;
+    name            miner;
+    asset           recd_apls;
+    asset           swap_tokens;
+    string          ads_id;
+
+    EOSLIB_SERIALIZE( ads_swap_log_t, (order_id)(miner)(recd_apls)(swap_tokens)(ads_id) )
+};
+
 } }
\ No newline at end of file
@@ -10,17 +10,25 @@ class [[eosio::contract("amax.one")]] amax_one: public eosio::contract {
 private:
     global_singleton    _global;
     global_t            _gstate;
+    swap_tiers_singleton _swap_tiers;
+    swap_tiers_t        _tiers;
+    bool                _tiers_loaded   = false;
+    bool                _tiers_changed  = false;
 
 public:
     using contract::contract;
 
     amax_one(eosio::name receiver, eosio::name code, datastream<const char*> ds):
          contract(receiver, code, ds),
-        _global(get_self(), get_self().value)
+        _global(get_self(), get_self().value),
+        _swap_tiers(get_self(), get_self().value)
     {
         _gstate = _global.exists() ? _global.get() : global_t{};
     }
-    ~amax_one() { _global.set( _gstate, get_self() ); }
+    ~amax_one() {
+        _global.set( _gstate, get_self() );
+        if (_tiers_changed) _swap_tiers.set( _tiers, get_self() );
+    }
 
 
     [[eosio::action]] void init(const name& admin, const name& mine_token_contract, time_point_sec started_at, time_point_sec ended_at);
@@ -40,8 +48,21 @@ public:
 
 
     [[eosio::action]] void confirmads( const uint64_t& order_id );
+
+    /**
+     * confirm many ads orders at once, each swap conf is updated once, each miner gets one transfer
+     * and all processed orders are logged by a single adsbatchlog action
+     * @param order_ids - ids of the ads orders to confirm, at most MAX_CONFIRM_BATCH
+     */
+    [[eosio::action]] void confirmadsbatch( const vector<uint64_t>& order_ids );
     [[eosio::action]] void onswapexpird( const uint64_t& order_id );
 
+    /**
+     * settle up to `max` expired ads orders, oldest expiry first, as onswapexpird does; anyone can call it
+     * @param max - maximum number of orders to settle
+     */
+    [[eosio::action]] void sweepexpired( const uint32_t& max );
+
      [[eosio::action]] void aplswaplog(
                     const name&         miner,
                     const asset&        recd_apls,
@@ -49,6 +70,8 @@ public:
                     const string&       ads_id,
                     const time_point&   created_at);
 
+    [[eosio::action]] void adsbatchlog( const vector<ads_swap_log_t>& orders, const time_point& created_at );
+
     [[eosio::action]] void addswapconf(
             const name&         account,
             const uint64_t&     amount,
@@ -61,10 +84,18 @@ public:
 
     [[eosio::action]] void setremained( const uint64_t& swap_conf_id, const asset& amount);
 
+    /**
+     * move the rows of the legacy swapconfs table into the swaptiers snapshot, once after upgrade;
+     * the swap confs can not be used until this is done
+     */
+    [[eosio::action]] void migrateconfs();
+
     using aplswaplog_action = eosio::action_wrapper<"aplswaplog"_n, &amax_one::aplswaplog>;
+    using adsbatchlog_action = eosio::action_wrapper<"adsbatchlog"_n, &amax_one::adsbatchlog>;
 
 private: 
-    void _claim_reward( const name& to, const asset& recd_apls, bool ads_checked, const string& ads_id, const string& memo );
+    void _claim_reward( const name& to, const asset& recd_apls, swap_conf_t& swap_conf, bool ads_checked, const string& ads_id, const string& memo );
+    swap_conf_t* _find_swap_conf( const uint64_t& swap_amount );
     void _on_apl_swap_log(
                     const name&         miner,
                     const asset&        recd_apls,
@@ -75,5 +106,6 @@ private:
     string_view _get_ads_id (const string& memo);
 
     void _add_adsorder(const name& miner, const asset& quantity, const string& ads_id);
+    bool _ads_id_existed(ads_order_t::tbl_t& ads_order_tbl, const string& ads_id);
     
 }; //contract amax.one
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include "amax_one.hpp"
 #include "utils.hpp"
 #include <chrono>
+#include <algorithm>
+#include <map>
 #include <amax.token/amax.token.hpp>
 #include <aplink.token/aplink.token.hpp>
 
@@ -45,10 +47,9 @@ void amax_one::ontransfer(name from, name to, asset quantity, string memo) {
     CHECK( time_point_sec(current_time_point()) <  _gstate.ended_at, "amax #1 already ended" )
     CHECK( quantity.symbol == APL_SYMBOL, "None APL symbol not allowed: " + quantity.to_string() )
 
-    swap_conf_t::tbl_t swap_conf_tbl(get_self(), get_self().value);
-    auto swap_conf_itr = swap_conf_tbl.find(quantity.amount);
-    CHECK( swap_conf_itr != swap_conf_tbl.end(), "swap amount not supported: " + quantity.to_string() )
-    CHECK( swap_conf_itr->mine_token_remained >=  swap_conf_itr->swap_tokens, "swap not enought amax ")
+    auto swap_conf = _find_swap_conf(quantity.amount);
+    CHECK( swap_conf != nullptr, "swap amount not supported: " + quantity.to_string() )
+    CHECK( swap_conf->mine_token_remained >=  swap_conf->swap_tokens, "swap not enought amax ")
 
     if(memo.length() > 10) {
         string_view ads_id = _get_ads_id(memo);
@@ -58,12 +59,13 @@ void amax_one::ontransfer(name from, name to, asset quantity, string memo) {
         }
     }
 
-    _claim_reward(from, quantity, false, "","");
+    _claim_reward(from, quantity, *swap_conf, false, "","");
 }
 
 void amax_one::_add_adsorder(const name& miner, const asset& quantity, const string& ads_id) {
     
     ads_order_t::tbl_t ads_order_tbl(get_self(), get_self().value);
+    CHECK( !_ads_id_existed(ads_order_tbl, ads_id), "ads_id already existed: " + ads_id )
 
     _gstate.last_order_id++;
     ads_order_tbl.emplace(get_self(), [&](auto &order) {
@@ -76,6 +78,16 @@ void amax_one::_add_adsorder(const name& miner, const asset& quantity, const str
     });
 }
 
+bool amax_one::_ads_id_existed(ads_order_t::tbl_t& ads_order_tbl, const string& ads_id) {
+    auto ads_idx = ads_order_tbl.get_index<"adsidx"_n>();
+    const auto key = hash128(ads_id);
+    // the key is a truncated hash, so compare the stored ads_id of every order sharing it
+    for (auto itr = ads_idx.lower_bound(key); itr != ads_idx.end() && itr->by_ads_id() == key; itr++) {
+        if (itr->ads_id == ads_id) return true;
+    }
+    return false;
+}
+
 void amax_one::confirmads( const uint64_t& order_id ) {
     
     require_auth(  _gstate.admin );
@@ -83,12 +95,66 @@ void amax_one::confirmads( const uint64_t& order_id ) {
     auto ads_order_idx = ads_order_tbl.find(order_id);
     check(ads_order_idx != ads_order_tbl.end(), "order_id not existed");
 
-    _claim_reward(ads_order_idx->miner, ads_order_idx->recd_apls,
+    auto swap_conf = _find_swap_conf(ads_order_idx->recd_apls.amount);
+    CHECK( swap_conf != nullptr, "swap conf not found: " + ads_order_idx->recd_apls.to_string() )
+    _claim_reward(ads_order_idx->miner, ads_order_idx->recd_apls, *swap_conf,
                      true, ads_order_idx->ads_id, "");
 
     ads_order_tbl.erase(ads_order_idx);
 }
 
+void amax_one::confirmadsbatch( const vector<uint64_t>& order_ids ) {
+    require_auth( _gstate.admin );
+    CHECK( !order_ids.empty(), "empty order_ids" )
+    CHECK( order_ids.size() <= MAX_CONFIRM_BATCH, "too many orders, max: " + to_string(MAX_CONFIRM_BATCH) )
+
+    ads_order_t::tbl_t ads_order_tbl(get_self(), get_self().value);
+    vector<ads_swap_log_t> logs;
+    logs.reserve( order_ids.size() );
+    for (const auto& order_id : order_ids) {
+        auto itr = ads_order_tbl.find(order_id);
+        CHECK( itr != ads_order_tbl.end(), "order_id not existed: " + to_string(order_id) )
+        logs.push_back( ads_swap_log_t{ order_id, itr->miner, itr->recd_apls, asset(), itr->ads_id } );
+        ads_order_tbl.erase(itr);
+    }
+
+    // group orders by swap amount so that each swap conf is checked and updated once
+    std::sort( logs.begin(), logs.end(), []( const auto& a, const auto& b ) {
+        return a.recd_apls.amount < b.recd_apls.amount;
+    });
+    for (size_t begin = 0; begin < logs.size(); ) {
+        const auto swap_amount = logs[begin].recd_apls.amount;
+        auto swap_conf = _find_swap_conf(swap_amount);
+        CHECK( swap_conf != nullptr, "swap conf not found: " + logs[begin].recd_apls.to_string() )
+
+        const asset swap_tokens = swap_conf->swap_tokens_after_adscheck;
+        CHECK( swap_tokens.amount > 0, "swap token must greater than 0" )
+
+        size_t end = begin;
+        while (end < logs.size() && logs[end].recd_apls.amount == swap_amount) {
+            logs[end++].swap_tokens = swap_tokens;
+        }
+        asset total_tokens = swap_tokens * int64_t(end - begin);
+        CHECK( total_tokens <= swap_conf->mine_token_remained, "reward token not enough" )
+        swap_conf->mine_token_remained -= total_tokens;
+        _tiers_changed = true;
+        begin = end;
+    }
+
+    // one transfer per miner
+    std::map<name, asset> miner_rewards;
+    for (const auto& log : logs) {
+        auto res = miner_rewards.emplace( log.miner, log.swap_tokens );
+        if (!res.second) res.first->second += log.swap_tokens;
+    }
+    for (const auto& reward : miner_rewards) {
+        TRANSFER(_gstate.mine_token_contract, reward.first, reward.second, "" )
+    }
+
+    amax_one::adsbatchlog_action act{ _self, { {_self, active_permission} } };
+    act.send( logs, current_time_point() );
+}
+
 void amax_one::onswapexpird( const uint64_t& order_id ) {
     require_auth(_gstate.admin);
 
@@ -97,15 +163,44 @@ void amax_one::onswapexpird( const uint64_t& order_id ) {
     auto itr = ads_order_tbl.find(order_id);
     CHECK(itr != ads_order_tbl.end(), "order_id not existed");
 
-    _claim_reward( itr->miner,  itr->recd_apls, false, "", "" );   
+    auto swap_conf = _find_swap_conf(itr->recd_apls.amount);
+    CHECK( swap_conf != nullptr, "swap conf not found: " + itr->recd_apls.to_string() )
+    _claim_reward( itr->miner,  itr->recd_apls, *swap_conf, false, "", "" );
     ads_order_tbl.erase(itr);
 }
 
+void amax_one::sweepexpired( const uint32_t& max ) {
+    CHECK( max > 0, "max must be positive" )
+
+    ads_order_t::tbl_t ads_order_tbl(get_self(), get_self().value);
+    auto expiry_idx = ads_order_tbl.get_index<"byexpiry"_n>();
+    const auto now = current_time_point().sec_since_epoch();
+    uint32_t count = 0;
+    for (auto itr = expiry_idx.begin(); itr != expiry_idx.end() && itr->expired_at.sec_since_epoch() <= now && count < max; ++count) {
+        auto swap_conf = _find_swap_conf(itr->recd_apls.amount);
+        CHECK( swap_conf != nullptr, "swap conf not found: " + itr->recd_apls.to_string() )
+        _claim_reward( itr->miner, itr->recd_apls, *swap_conf, false, "", "" );
+        itr = expiry_idx.erase(itr);
+    }
+    CHECK( count > 0, "no expired order" )
+}
+
  void amax_one::aplswaplog( const name& miner, const asset& recd_apls, const asset& swap_tokens, const string& ads_id, const time_point& created_at) {
     require_auth(get_self());
     require_recipient(miner);
  }
 
+void amax_one::adsbatchlog( const vector<ads_swap_log_t>& orders, const time_point& created_at ) {
+    require_auth(get_self());
+
+    vector<name> miners;
+    miners.reserve( orders.size() );
+    for (const auto& order : orders) miners.push_back( order.miner );
+    std::sort( miners.begin(), miners.end() );
+    miners.erase( std::unique( miners.begin(), miners.end() ), miners.end() );
+    for (const auto& miner : miners) require_recipient(miner);
+}
+
 void amax_one::addswapconf(
             const name&         account,
             const uint64_t&     swap_amount,
@@ -117,30 +212,32 @@ void amax_one::addswapconf(
     require_auth( account );
     CHECK(account == _self || account == _gstate.admin , "no auth for operate");
 
-    swap_conf_t::tbl_t swap_conf_tbl(get_self(), get_self().value);
-    auto swap_conf_itr = swap_conf_tbl.find(swap_amount);
-    CHECK( swap_conf_itr == swap_conf_tbl.end(), "swap conf already existed: " + to_string(swap_amount) )
-
-    swap_conf_tbl.emplace( _self, [&](auto &conf) {
-        conf.swap_amount                = swap_amount;
-        conf.swap_tokens                = swap_tokens;
-        conf.swap_tokens_after_adscheck   = swap_tokens_after_adscheck;
-        conf.mine_token_total           = mine_token_total;
-        conf.mine_token_remained        = mine_token_remained;
+    CHECK( _find_swap_conf(swap_amount) == nullptr, "swap conf already existed: " + to_string(swap_amount) )
+
+    swap_conf_t conf;
+    conf.swap_amount                = swap_amount;
+    conf.swap_tokens                = swap_tokens;
+    conf.swap_tokens_after_adscheck   = swap_tokens_after_adscheck;
+    conf.mine_token_total           = mine_token_total;
+    conf.mine_token_remained        = mine_token_remained;
+
+    auto& tiers = _tiers.tiers;
+    auto itr = std::lower_bound( tiers.begin(), tiers.end(), swap_amount, []( const auto& c, uint64_t amount ) {
+        return c.swap_amount < amount;
     });
+    tiers.insert( itr, conf );
+    _tiers_changed = true;
 
 }
 
 void amax_one::setremained( const uint64_t& swap_amount, const asset& amount) {
     require_auth( _self );
 
-    swap_conf_t::tbl_t swap_conf_tbl(get_self(), get_self().value);
-    auto swap_conf_itr = swap_conf_tbl.find(swap_amount);
-    CHECK( swap_conf_itr != swap_conf_tbl.end(), "swap conf not existing: " + to_string(swap_amount) )
-    
-    swap_conf_tbl.modify( swap_conf_itr, get_self(), [&]( auto& swap_conf ) {
-        swap_conf.mine_token_remained = amount;
-    });
+    auto swap_conf = _find_swap_conf(swap_amount);
+    CHECK( swap_conf != nullptr, "swap conf not existing: " + to_string(swap_amount) )
+
+    swap_conf->mine_token_remained = amount;
+    _tiers_changed = true;
 
 }
     
@@ -149,31 +246,59 @@ void amax_one::delswapconf( const name& account, const uint64_t amount)
     require_auth( account );
     CHECK(account == _self || account == _gstate.admin , "no auth for operate");
 
+    auto swap_conf = _find_swap_conf(amount);
+    CHECK( swap_conf != nullptr, "swap conf not found: " + to_string(amount) )
+    _tiers.tiers.erase( _tiers.tiers.begin() + (swap_conf - _tiers.tiers.data()) );
+    _tiers_changed = true;
+}
+
+void amax_one::migrateconfs() {
+    require_auth( _self );
+    CHECK( !_swap_tiers.exists(), "swap confs already migrated" )
+
+    // legacy rows are read in primary key order, i.e. sorted by swap_amount as the snapshot is
     swap_conf_t::tbl_t swap_conf_tbl(get_self(), get_self().value);
-    auto swap_conf_itr = swap_conf_tbl.find(amount);
-    CHECK( swap_conf_itr != swap_conf_tbl.end(), "swap conf not found: " + to_string(amount) )
-    swap_conf_tbl.erase(swap_conf_itr);
+    for (auto itr = swap_conf_tbl.begin(); itr != swap_conf_tbl.end(); ) {
+        _tiers.tiers.push_back( *itr );
+        itr = swap_conf_tbl.erase(itr);
+    }
+    _tiers_loaded = true;
+    _tiers_changed = true;
+}
+
+swap_conf_t* amax_one::_find_swap_conf( const uint64_t& swap_amount ) {
+    if (!_tiers_loaded) {
+        _tiers_loaded = true;
+        if (_swap_tiers.exists()) {
+            _tiers = _swap_tiers.get();
+        } else {
+            swap_conf_t::tbl_t swap_conf_tbl(get_self(), get_self().value);
+            CHECK( swap_conf_tbl.begin() == swap_conf_tbl.end(), "swap confs not migrated" )
+        }
+    }
+
+    auto& tiers = _tiers.tiers;
+    auto itr = std::lower_bound( tiers.begin(), tiers.end(), swap_amount, []( const auto& c, uint64_t amount ) {
+        return c.swap_amount < amount;
+    });
+    return (itr != tiers.end() && itr->swap_amount == swap_amount) ? &*itr : nullptr;
 }
 
 void amax_one::_claim_reward( const name&   to, 
                         const asset&        recd_apls,
+                        swap_conf_t&        swap_conf,
                         bool                ads_checked,
                         const string&       ads_id, 
                         const string&       memo ) 
 {
-    swap_conf_t::tbl_t swap_conf_tbl(get_self(), get_self().value);
-    auto swap_conf_itr = swap_conf_tbl.find(recd_apls.amount);
-    CHECK( swap_conf_itr != swap_conf_tbl.end(), "swap conf not found: " + recd_apls.to_string() )
-
-    asset swap_tokens = swap_conf_itr->swap_tokens;
-    if (ads_checked) swap_tokens = swap_conf_itr->swap_tokens_after_adscheck;
+    asset swap_tokens = swap_conf.swap_tokens;
+    if (ads_checked) swap_tokens = swap_conf.swap_tokens_after_adscheck;
 
     CHECK(swap_tokens.amount > 0, "swap token must greater than 0");
 
-    CHECK( swap_tokens <= swap_conf_itr->mine_token_remained, "reward token not enough" )
-    swap_conf_tbl.modify( swap_conf_itr, get_self(), [&]( auto& swap_conf ) {
-        swap_conf.mine_token_remained = swap_conf_itr->mine_token_remained - swap_tokens;
-    });
+    CHECK( swap_tokens <= swap_conf.mine_token_remained, "reward token not enough" )
+    swap_conf.mine_token_remained -= swap_tokens;
+    _tiers_changed = true;
 
     TRANSFER(_gstate.mine_token_contract, to, swap_tokens, memo )
     _on_apl_swap_log(to, recd_apls, swap_tokens, ads_id, current_time_point());
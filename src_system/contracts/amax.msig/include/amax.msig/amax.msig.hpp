@@ -1,6 +1,7 @@
 #pragma once
 
 #include <eosio/binary_extension.hpp>
+#include <eosio/crypto.hpp>
 #include <eosio/eosio.hpp>
 #include <eosio/ignore.hpp>
 #include <eosio/transaction.hpp>
@@ -105,6 +106,35 @@ namespace eosio {
           */
          [[eosio::action]]
          void invalidate( name account );
+         /**
+          * Proposebig action, creates a proposal whose transaction is too big for a single `propose`.
+          * The packed transaction is then uploaded with `chunk_count` calls of `uploadchunk`; the proposal
+          * can be approved and executed like any other once the last chunk is uploaded and verified.
+          * Storage changes are billed to `proposer`.
+          *
+          * @param proposer - The account proposing a transaction
+          * @param proposal_name - The name of the proposal (should be unique for proposer)
+          * @param requested - Permission levels expected to approve the proposal
+          * @param chunk_count - Number of chunks the packed transaction is split into
+          */
+         [[eosio::action]]
+         void proposebig( name proposer, name proposal_name, std::vector<permission_level> requested, uint32_t chunk_count );
+         /**
+          * Uploadchunk action, uploads chunk `index` of a proposal created by `proposebig`. Chunks must be
+          * uploaded in order. `running_hash` is the sha256 of the previous running hash (zero for the first
+          * chunk) followed by `data`; it is recomputed and checked on every upload. Once the last chunk is
+          * uploaded, the proposal hash expected by `approve` is the sha256 of the assembled packed transaction,
+          * the same hash a proposal made with `propose` has.
+          *
+          * @param proposer - The account proposing a transaction
+          * @param proposal_name - The name of the proposal created by `proposebig`
+          * @param index - Index of the chunk, starting from 0
+          * @param data - Bytes of the packed transaction in this chunk
+          * @param running_hash - Expected running hash after this chunk
+          */
+         [[eosio::action]]
+         void uploadchunk( name proposer, name proposal_name, uint32_t index, const std::vector<char>& data,
+                           const eosio::checksum256& running_hash );
 
          using propose_action = eosio::action_wrapper<"propose"_n, &multisig::propose>;
          using approve_action = eosio::action_wrapper<"approve"_n, &multisig::approve>;
@@ -112,11 +142,16 @@ namespace eosio {
          using cancel_action = eosio::action_wrapper<"cancel"_n, &multisig::cancel>;
          using exec_action = eosio::action_wrapper<"exec"_n, &multisig::exec>;
          using invalidate_action = eosio::action_wrapper<"invalidate"_n, &multisig::invalidate>;
+         using proposebig_action = eosio::action_wrapper<"proposebig"_n, &multisig::proposebig>;
+         using uploadchunk_action = eosio::action_wrapper<"uploadchunk"_n, &multisig::uploadchunk>;
+
+   static constexpr uint32_t max_proposal_chunks = 64;
 
    struct [[eosio::table, eosio::contract("amax.msig")]] proposal {
       name                                                            proposal_name;
       std::vector<char>                                               packed_transaction;
       eosio::binary_extension< time_point >                           earliest_exec_time;
+      eosio::binary_extension< eosio::checksum256 >                   trx_hash;   // sha256 of packed_transaction
 
       uint64_t primary_key()const { return proposal_name.value; }
    };
@@ -133,12 +168,39 @@ namespace eosio {
       //requested approval doesn't need to contain time, but we want requested approval
       //to be of exactly the same size as provided approval, in this case approve/unapprove
       //doesn't change serialized data size. So, we use the same type.
+      //both lists are kept sorted by level, so approve/unapprove find a level by binary search
       std::vector<approval>   requested_approvals;
       std::vector<approval>   provided_approvals;
       uint64_t primary_key()const { return proposal_name.value; }
    };
    typedef eosio::multi_index< "approvals2"_n, approvals_info > approvals;
 
+   //progress of a proposal uploaded in chunks, its `packed_transaction` stays empty
+   struct [[eosio::table, eosio::contract("amax.msig")]] proposal_upload {
+      name                    proposal_name;
+      uint32_t                chunk_count    = 0;
+      uint32_t                uploaded_count = 0;
+      uint64_t                total_size     = 0;
+      eosio::checksum256      running_hash;
+
+      bool is_complete()const { return uploaded_count == chunk_count; }
+      uint64_t primary_key()const { return proposal_name.value; }
+   };
+   typedef eosio::multi_index< "propupload"_n, proposal_upload > proposal_uploads;
+
+   struct [[eosio::table, eosio::contract("amax.msig")]] proposal_chunk {
+      uint64_t                id;
+      name                    proposal_name;
+      uint32_t                index;
+      std::vector<char>       data;
+
+      uint64_t primary_key()const { return id; }
+      uint128_t by_proposal()const { return (uint128_t(proposal_name.value) << 64) | index; }
+   };
+   typedef eosio::multi_index< "propchunk"_n, proposal_chunk,
+      indexed_by<"byproposal"_n, const_mem_fun<proposal_chunk, uint128_t, &proposal_chunk::by_proposal> >
+   > proposal_chunks;
+
    struct [[eosio::table, eosio::contract("amax.msig")]] invalidation {
          name         account;
          time_point   last_invalidation_time;
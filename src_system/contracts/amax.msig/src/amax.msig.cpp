@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <utility>
+
 #include <eosio/action.hpp>
 #include <eosio/crypto.hpp>
 #include <eosio/permission.hpp>
@@ -8,27 +11,165 @@ namespace eosio {
 
 transaction_header get_trx_header(const char* ptr, size_t sz);
 bool trx_is_authorized(const std::vector<permission_level>& approvals, const std::vector<char>& packed_trx);
+void skip_packed_action(datastream<const char*>& ds);
+
+//position of `level` in `approvals`, which are sorted by level, or the position it would be inserted at
+size_t approval_position(const std::vector<multisig::approval>& approvals, const permission_level& level) {
+   auto itr = std::lower_bound( approvals.begin(), approvals.end(), level,
+                                [](const multisig::approval& a, const permission_level& l) { return a.level < l; } );
+   return itr - approvals.begin();
+}
+
+//index of `level` in `approvals`, or -1. Lists written by `propose` are sorted by level and found by
+//binary search, rows stored before the lists were kept sorted fall back to a linear scan
+int find_approval(const std::vector<multisig::approval>& approvals, const permission_level& level) {
+   size_t pos = approval_position( approvals, level );
+   if ( pos < approvals.size() && approvals[pos].level == level ) {
+      return int(pos);
+   }
+   auto itr = std::find_if( approvals.begin(), approvals.end(), [&](const multisig::approval& a) { return a.level == level; } );
+   return itr != approvals.end() ? int(itr - approvals.begin()) : -1;
+}
+
+//last invalidation times of the given actors, sorted by actor. The invalidations table is walked
+//once in key order, actors falling between two existing rows are resolved without a row read
+std::vector<std::pair<name, time_point>> load_invalidations(name self, std::vector<name> actors) {
+   std::vector<std::pair<name, time_point>> result;
+   multisig::invalidations invalidations_table( self, self.value );
+   auto iter = invalidations_table.begin();
+   if ( iter == invalidations_table.end() ) {
+      return result;
+   }
+   std::sort( actors.begin(), actors.end() );
+   actors.erase( std::unique( actors.begin(), actors.end() ), actors.end() );
+   for ( const auto& actor : actors ) {
+      if ( iter != invalidations_table.end() && iter->account < actor ) {
+         iter = invalidations_table.lower_bound( actor.value );
+      }
+      if ( iter == invalidations_table.end() ) {
+         break;
+      }
+      if ( iter->account == actor ) {
+         result.emplace_back( actor, iter->last_invalidation_time );
+      }
+   }
+   return result;
+}
 
 template<typename Function>
 std::vector<permission_level> get_approvals_and_adjust_table(name self, name proposer, name proposal_name, Function&& table_op) {
    multisig::approvals approval_table( self, proposer.value );
    auto approval_table_iter = approval_table.find( proposal_name.value );
-   std::vector<permission_level> approvals_vector;
-   multisig::invalidations invalidations_table( self, self.value );
 
    check( approval_table_iter != approval_table.end(), "proposal not found" );
-   approvals_vector.reserve( approval_table_iter->provided_approvals.size() );
-   for ( const auto& permission : approval_table_iter->provided_approvals ) {
-      auto iter = invalidations_table.find( permission.level.actor.value );
-      if ( iter == invalidations_table.end() || iter->last_invalidation_time < permission.time ) {
-         approvals_vector.push_back(permission.level);
+   const auto& provided = approval_table_iter->provided_approvals;
+
+   std::vector<name> actors;
+   actors.reserve( provided.size() );
+   for ( const auto& permission : provided ) {
+      actors.push_back( permission.level.actor );
+   }
+   const auto invalidations = load_invalidations( self, std::move(actors) );
+
+   std::vector<permission_level> approvals_vector;
+   approvals_vector.reserve( provided.size() );
+   for ( const auto& permission : provided ) {
+      auto iter = std::lower_bound( invalidations.begin(), invalidations.end(), permission.level.actor,
+                                    [](const auto& inv, name actor) { return inv.first < actor; } );
+      if ( iter == invalidations.end() || iter->first != permission.level.actor || iter->second < permission.time ) {
+         approvals_vector.push_back( permission.level );
       }
    }
+
    table_op( approval_table, approval_table_iter );
 
    return approvals_vector;
 }
 
+void check_proposed_trx(const char* trx_pos, size_t size, const std::vector<permission_level>& requested) {
+   datastream<const char*> ds( trx_pos, size );
+   transaction_header trx_header;
+   unsigned_int context_free_actions_count;
+   ds >> trx_header;
+   check( trx_header.expiration >= eosio::time_point_sec(current_time_point()), "transaction expired" );
+   ds >> context_free_actions_count;
+   check( context_free_actions_count.value == 0, "not allowed to `propose` a transaction with context-free actions" );
+
+   auto packed_requested = pack(requested);
+   auto res =  check_transaction_authorization(
+                  trx_pos, size,
+                  (const char*)0, 0,
+                  packed_requested.data(), packed_requested.size()
+                                );
+
+   check( res > 0, "transaction authorization failed" );
+}
+
+void emplace_approvals(name self, name proposer, name proposal_name, std::vector<permission_level> requested) {
+   std::sort( requested.begin(), requested.end() );
+   requested.erase( std::unique( requested.begin(), requested.end() ), requested.end() );
+
+   multisig::approvals apptable( self, proposer.value );
+   apptable.emplace( proposer, [&]( auto& a ) {
+         a.proposal_name = proposal_name;
+         a.requested_approvals.reserve( requested.size() );
+         for ( auto& level : requested ) {
+            a.requested_approvals.push_back( multisig::approval{ level, time_point{ microseconds{0} } } );
+         }
+      });
+}
+
+//the packed transaction of `prop`, assembled into `buffer` if it was uploaded in chunks
+const std::vector<char>& get_packed_trx(name self, name proposer, const multisig::proposal& prop, std::vector<char>& buffer) {
+   if( !prop.packed_transaction.empty() ) {
+      return prop.packed_transaction;
+   }
+   multisig::proposal_uploads uploads( self, proposer.value );
+   const auto& upload = uploads.get( prop.proposal_name.value, "proposal not found" );
+   check( upload.is_complete(), "proposal upload not finished" );
+
+   multisig::proposal_chunks chunks( self, proposer.value );
+   auto idx = chunks.get_index<"byproposal"_n>();
+   buffer.clear();
+   buffer.reserve( upload.total_size );
+   for( auto itr = idx.lower_bound( uint128_t(prop.proposal_name.value) << 64 );
+        itr != idx.end() && itr->proposal_name == prop.proposal_name; ++itr ) {
+      buffer.insert( buffer.end(), itr->data.begin(), itr->data.end() );
+   }
+   return buffer;
+}
+
+//the header only needs the first chunk of a proposal uploaded in chunks
+transaction_header get_proposal_trx_header(name self, name proposer, const multisig::proposal& prop) {
+   if( !prop.packed_transaction.empty() ) {
+      return get_trx_header( prop.packed_transaction.data(), prop.packed_transaction.size() );
+   }
+   multisig::proposal_uploads uploads( self, proposer.value );
+   const auto& upload = uploads.get( prop.proposal_name.value, "proposal not found" );
+   check( upload.is_complete(), "proposal upload not finished" );
+
+   multisig::proposal_chunks chunks( self, proposer.value );
+   auto idx = chunks.get_index<"byproposal"_n>();
+   const auto& first = idx.get( uint128_t(prop.proposal_name.value) << 64, "proposal chunk not found" );
+   return get_trx_header( first.data.data(), first.data.size() );
+}
+
+void erase_chunks(name self, name proposer, name proposal_name) {
+   multisig::proposal_uploads uploads( self, proposer.value );
+   auto upload_it = uploads.find( proposal_name.value );
+   if( upload_it == uploads.end() ) {
+      return;
+   }
+   uploads.erase( upload_it );
+
+   multisig::proposal_chunks chunks( self, proposer.value );
+   auto idx = chunks.get_index<"byproposal"_n>();
+   auto itr = idx.lower_bound( uint128_t(proposal_name.value) << 64 );
+   while( itr != idx.end() && itr->proposal_name == proposal_name ) {
+      itr = idx.erase( itr );
+   }
+}
+
 void multisig::propose( name proposer,
                         name proposal_name,
                         std::vector<permission_level> requested,
@@ -40,24 +181,10 @@ void multisig::propose( name proposer,
    const char* trx_pos = ds.pos();
    size_t size = ds.remaining();
 
-   transaction_header trx_header;
-   std::vector<action> context_free_actions;
-   ds >> trx_header;
-   check( trx_header.expiration >= eosio::time_point_sec(current_time_point()), "transaction expired" );
-   ds >> context_free_actions;
-   check( context_free_actions.empty(), "not allowed to `propose` a transaction with context-free actions" );
-
    proposals proptable( get_self(), proposer.value );
    check( proptable.find( proposal_name.value ) == proptable.end(), "proposal with the same name exists" );
 
-   auto packed_requested = pack(requested);
-   auto res =  check_transaction_authorization(
-                  trx_pos, size,
-                  (const char*)0, 0,
-                  packed_requested.data(), packed_requested.size()
-                                );
-
-   check( res > 0, "transaction authorization failed" );
+   check_proposed_trx( trx_pos, size, requested );
 
    std::vector<char> pkd_trans;
    pkd_trans.resize(size);
@@ -67,16 +194,95 @@ void multisig::propose( name proposer,
          prop.proposal_name      = proposal_name;
          prop.packed_transaction = pkd_trans;
          prop.earliest_exec_time.emplace();
+         prop.trx_hash.emplace( sha256( trx_pos, size ) );
       });
 
-   approvals apptable( get_self(), proposer.value );
-   apptable.emplace( proposer, [&]( auto& a ) {
-         a.proposal_name = proposal_name;
-         a.requested_approvals.reserve( requested.size() );
-         for ( auto& level : requested ) {
-            a.requested_approvals.push_back( approval{ level, time_point{ microseconds{0} } } );
-         }
+   emplace_approvals( get_self(), proposer, proposal_name, std::move(requested) );
+}
+
+void multisig::proposebig( name proposer, name proposal_name, std::vector<permission_level> requested, uint32_t chunk_count ) {
+   require_auth( proposer );
+   check( chunk_count > 0 && chunk_count <= max_proposal_chunks, "invalid chunk count" );
+
+   proposals proptable( get_self(), proposer.value );
+   check( proptable.find( proposal_name.value ) == proptable.end(), "proposal with the same name exists" );
+
+   proptable.emplace( proposer, [&]( auto& prop ) {
+         prop.proposal_name      = proposal_name;
+         prop.earliest_exec_time.emplace();
+      });
+
+   proposal_uploads uploads( get_self(), proposer.value );
+   uploads.emplace( proposer, [&]( auto& u ) {
+         u.proposal_name   = proposal_name;
+         u.chunk_count     = chunk_count;
+      });
+
+   emplace_approvals( get_self(), proposer, proposal_name, std::move(requested) );
+}
+
+void multisig::uploadchunk( name proposer, name proposal_name, uint32_t index, const std::vector<char>& data,
+                            const eosio::checksum256& running_hash ) {
+   require_auth( proposer );
+   check( !data.empty(), "empty chunk" );
+
+   proposal_uploads uploads( get_self(), proposer.value );
+   const auto& upload = uploads.get( proposal_name.value, "proposal not found" );
+   check( !upload.is_complete(), "proposal upload already finished" );
+   check( index == upload.uploaded_count, "chunks must be uploaded in order" );
+
+   std::vector<char> hashed;
+   hashed.reserve( 32 + data.size() );
+   auto prev_hash = upload.running_hash.extract_as_byte_array();
+   hashed.insert( hashed.end(), prev_hash.begin(), prev_hash.end() );
+   hashed.insert( hashed.end(), data.begin(), data.end() );
+   auto new_hash = sha256( hashed.data(), hashed.size() );
+   check( new_hash == running_hash, "running hash mismatch" );
+
+   if( index == 0 ) {
+      check( get_trx_header( data.data(), data.size() ).expiration >= eosio::time_point_sec(current_time_point()), "transaction expired" );
+   }
+
+   proposal_chunks chunks( get_self(), proposer.value );
+   chunks.emplace( proposer, [&]( auto& c ) {
+         c.id              = chunks.available_primary_key();
+         c.proposal_name   = proposal_name;
+         c.index           = index;
+         c.data            = data;
       });
+
+   uploads.modify( upload, same_payer, [&]( auto& u ) {
+         u.uploaded_count += 1;
+         u.total_size     += data.size();
+         u.running_hash    = new_hash;
+      });
+
+   if( upload.is_complete() ) {
+      //verify the assembled transaction as `propose` does
+      proposals proptable( get_self(), proposer.value );
+      auto& prop = proptable.get( proposal_name.value, "proposal not found" );
+
+      approvals apptable( get_self(), proposer.value );
+      const auto& apps = apptable.get( proposal_name.value, "proposal not found" );
+      std::vector<permission_level> requested;
+      requested.reserve( apps.requested_approvals.size() + apps.provided_approvals.size() );
+      for( const auto& a : apps.requested_approvals ) {
+         requested.push_back( a.level );
+      }
+      for( const auto& a : apps.provided_approvals ) {
+         requested.push_back( a.level );
+      }
+
+      std::vector<char> buffer;
+      const auto& packed_trx = get_packed_trx( get_self(), proposer, prop, buffer );
+      check_proposed_trx( packed_trx.data(), packed_trx.size(), requested );
+
+      //the proposal hash is the hash of the whole transaction, as for `propose`, the running hash
+      //only stays in the upload row to check the chunks
+      proptable.modify( prop, same_payer, [&]( auto& p ) {
+            p.trx_hash.emplace( sha256( packed_trx.data(), packed_trx.size() ) );
+         });
+   }
 }
 
 void multisig::approve( name proposer, name proposal_name, permission_level level,
@@ -88,26 +294,32 @@ void multisig::approve( name proposer, name proposal_name, permission_level leve
    auto& prop = proptable.get( proposal_name.value, "proposal not found" );
 
    if( proposal_hash ) {
-      assert_sha256( prop.packed_transaction.data(), prop.packed_transaction.size(), *proposal_hash );
+      if( prop.trx_hash.has_value() ) {
+         check( *prop.trx_hash == *proposal_hash, "hash mismatch" );
+      } else {
+         assert_sha256( prop.packed_transaction.data(), prop.packed_transaction.size(), *proposal_hash );
+      }
    }
 
    approvals apptable( get_self(), proposer.value );
    auto apps_it = apptable.find( proposal_name.value );
    check( apps_it != apptable.end(), "proposal not found" );
-   auto itr = std::find_if( apps_it->requested_approvals.begin(), apps_it->requested_approvals.end(), [&](const approval& a) { return a.level == level; } );
-   check( itr != apps_it->requested_approvals.end(), "approval is not on the list of requested approvals" );
+   int idx = find_approval( apps_it->requested_approvals, level );
+   check( idx >= 0, "approval is not on the list of requested approvals" );
+   size_t prov_pos = approval_position( apps_it->provided_approvals, level );
 
    apptable.modify( apps_it, same_payer, [&]( auto& a ) {
-         a.provided_approvals.push_back( approval{ level, current_time_point() } );
-         a.requested_approvals.erase( itr );
+         a.requested_approvals.erase( a.requested_approvals.begin() + idx );
+         a.provided_approvals.insert( a.provided_approvals.begin() + prov_pos, approval{ level, current_time_point() } );
       });
 
-   transaction_header trx_header = get_trx_header(prop.packed_transaction.data(), prop.packed_transaction.size());
+   transaction_header trx_header = get_proposal_trx_header(get_self(), proposer, prop);
 
    if( prop.earliest_exec_time.has_value() ) {
       if( trx_header.delay_sec.value != 0 && prop.earliest_exec_time->elapsed.count() == 0 ) {
          auto table_op = [](auto&&, auto&&){};
-         if( trx_is_authorized(get_approvals_and_adjust_table(get_self(), proposer, proposal_name, table_op), prop.packed_transaction) ) {
+         std::vector<char> buffer;
+         if( trx_is_authorized(get_approvals_and_adjust_table(get_self(), proposer, proposal_name, table_op), get_packed_trx(get_self(), proposer, prop, buffer)) ) {
             proptable.modify( prop, same_payer, [&]( auto& p ) {
                p.earliest_exec_time.emplace(current_time_point() + eosio::seconds(trx_header.delay_sec.value));
             });
@@ -124,11 +336,13 @@ void multisig::unapprove( name proposer, name proposal_name, permission_level le
    approvals apptable( get_self(), proposer.value );
    auto apps_it = apptable.find( proposal_name.value );
    check( apps_it != apptable.end(), "proposal not found" );
-   auto itr = std::find_if( apps_it->provided_approvals.begin(), apps_it->provided_approvals.end(), [&](const approval& a) { return a.level == level; } );
-   check( itr != apps_it->provided_approvals.end(), "no approval previously granted" );
+   int idx = find_approval( apps_it->provided_approvals, level );
+   check( idx >= 0, "no approval previously granted" );
+   size_t req_pos = approval_position( apps_it->requested_approvals, level );
+
    apptable.modify( apps_it, same_payer, [&]( auto& a ) {
-         a.requested_approvals.push_back( approval{ level, current_time_point() } );
-         a.provided_approvals.erase( itr );
+         a.provided_approvals.erase( a.provided_approvals.begin() + idx );
+         a.requested_approvals.insert( a.requested_approvals.begin() + req_pos, approval{ level, current_time_point() } );
       });
 
    proposals proptable( get_self(), proposer.value );
@@ -137,7 +351,8 @@ void multisig::unapprove( name proposer, name proposal_name, permission_level le
    if( prop.earliest_exec_time.has_value() ) {
       if( prop.earliest_exec_time->elapsed.count() != 0 ) {
          auto table_op = [](auto&&, auto&&){};
-         if( !trx_is_authorized(get_approvals_and_adjust_table(get_self(), proposer, proposal_name, table_op), prop.packed_transaction) ) {
+         std::vector<char> buffer;
+         if( !trx_is_authorized(get_approvals_and_adjust_table(get_self(), proposer, proposal_name, table_op), get_packed_trx(get_self(), proposer, prop, buffer)) ) {
             proptable.modify( prop, same_payer, [&]( auto& p ) {
                p.earliest_exec_time.emplace();
             });
@@ -156,9 +371,10 @@ void multisig::cancel( name proposer, name proposal_name, name canceler ) {
    auto& prop = proptable.get( proposal_name.value, "proposal not found" );
 
    if( canceler != proposer ) {
-      check( unpack<transaction_header>( prop.packed_transaction ).expiration < eosio::time_point_sec(current_time_point()), "cannot cancel until expiration" );
+      check( get_proposal_trx_header(get_self(), proposer, prop).expiration < eosio::time_point_sec(current_time_point()), "cannot cancel until expiration" );
    }
    proptable.erase(prop);
+   erase_chunks( get_self(), proposer, proposal_name );
 
    //remove from new table
    approvals apptable( get_self(), proposer.value );
@@ -173,17 +389,19 @@ void multisig::exec( name proposer, name proposal_name, name executer ) {
    proposals proptable( get_self(), proposer.value );
    auto& prop = proptable.get( proposal_name.value, "proposal not found" );
    transaction_header trx_header;
-   std::vector<action> context_free_actions;
-   std::vector<action> actions;
-   datastream<const char*> ds( prop.packed_transaction.data(), prop.packed_transaction.size() );
+   unsigned_int context_free_actions_count;
+   unsigned_int actions_count;
+   std::vector<char> buffer;
+   const auto& packed_trx = get_packed_trx( get_self(), proposer, prop, buffer );
+   datastream<const char*> ds( packed_trx.data(), packed_trx.size() );
    ds >> trx_header;
    check( trx_header.expiration >= eosio::time_point_sec(current_time_point()), "transaction expired" );
-   ds >> context_free_actions;
-   check( context_free_actions.empty(), "not allowed to `exec` a transaction with context-free actions" );
-   ds >> actions;
+   ds >> context_free_actions_count;
+   check( context_free_actions_count.value == 0, "not allowed to `exec` a transaction with context-free actions" );
+   ds >> actions_count;
 
    auto table_op = [](auto&& table, auto&& table_iter) { table.erase(table_iter); };
-   bool ok = trx_is_authorized(get_approvals_and_adjust_table(get_self(), proposer, proposal_name, table_op), prop.packed_transaction);
+   bool ok = trx_is_authorized(get_approvals_and_adjust_table(get_self(), proposer, proposal_name, table_op), packed_trx);
    check( ok, "transaction authorization failed" );
 
    if ( prop.earliest_exec_time.has_value() && prop.earliest_exec_time->elapsed.count() != 0 ) {
@@ -192,11 +410,15 @@ void multisig::exec( name proposer, name proposal_name, name executer ) {
       check( trx_header.delay_sec.value == 0, "old proposals are not allowed to have non-zero `delay_sec`; cancel and retry" );
    }
 
-   for (const auto& act : actions) {
-      act.send();
+   // forward the serialized actions as they are stored, without unpacking them
+   for (uint32_t i = 0; i < actions_count.value; ++i) {
+      const char* act_pos = ds.pos();
+      skip_packed_action( ds );
+      internal_use_do_not_use::send_inline( const_cast<char*>(act_pos), ds.pos() - act_pos );
    }
 
    proptable.erase(prop);
+   erase_chunks( get_self(), proposer, proposal_name );
 }
 
 void multisig::invalidate( name account ) {
@@ -215,6 +437,17 @@ void multisig::invalidate( name account ) {
    }
 }
 
+void skip_packed_action(datastream<const char*>& ds) {
+   unsigned_int authorization_count;
+   unsigned_int data_size;
+   ds.skip( sizeof(name) * 2 ); // account, name
+   ds >> authorization_count;
+   ds.skip( authorization_count.value * sizeof(permission_level) );
+   ds >> data_size;
+   check( data_size.value <= ds.remaining(), "invalid packed transaction" );
+   ds.skip( data_size.value );
+}
+
 transaction_header get_trx_header(const char* ptr, size_t sz) {
    datastream<const char*> ds = {ptr, sz};
    transaction_header trx_header;
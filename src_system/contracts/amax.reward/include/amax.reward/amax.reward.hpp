@@ -1,11 +1,16 @@
 #pragma once
 
 #include <eosio/asset.hpp>
+#include <eosio/binary_extension.hpp>
 #include <eosio/eosio.hpp>
 #include <eosio/singleton.hpp>
 #include <eosio/privileged.hpp>
 
+#include <algorithm>
+#include <optional>
 #include <string>
+#include <utility>
+#include <vector>
 
 #define PP(prop) "," #prop ":", prop
 #define PP0(prop) #prop ":", prop
@@ -31,6 +36,8 @@ namespace amax {
    static constexpr symbol    vote_symbol       = symbol("VOTE", 4);
    static const asset         vote_asset_0      = asset(0, vote_symbol);
    static constexpr int128_t  HIGH_PRECISION    = 1'000'000'000'000'000'000; // 10^18
+   static constexpr uint32_t  REWARD_EPOCH_SEC  = 24 * 3600;  // pending rewards are credited once per epoch
+   static constexpr uint32_t  MAX_CLAIM_BATCH   = 100;
 
    struct amax_system {
       // Defines new global state parameters.
@@ -68,11 +75,18 @@ namespace amax {
                contract(s, code, ds),
                _global(get_self(), get_self().value),
                _voter_tbl(get_self(), get_self().value),
-               _producer_tbl(get_self(), get_self().value)
+               _producer_tbl(get_self(), get_self().value),
+               _pending_tbl(get_self(), get_self().value),
+               _lazy_tbl(get_self(), get_self().value)
          {
             _gstate  = _global.exists() ? _global.get() : global_state{};
          }
 
+         ~amax_reward() {
+            if (_gstate_changed) _global.set(_gstate, get_self());
+            if (_lazy_changed) _lazy_tbl.set(*_lazy, get_self());
+         }
+
          /**
           * Register producer action.
           * Producer must register before add rewards.
@@ -121,6 +135,40 @@ namespace amax {
          void claimrewards( const name& voter_name );
 
          ACTION claimfor(const name& submitter, const name& voter );
+
+         struct claim_result {
+            name              voter;
+            asset             rewards;    // claimed rewards, zero if voter not found or nothing to claim
+         };
+
+         /**
+          * claim rewards for a batch of voters, rewards of each voter are transferred to the voter.
+          * Voters without rewards are skipped instead of failing the batch.
+          *
+          * @param submitter - the account submitting the claim
+          * @param voters - the voters to claim rewards for, a maximum of 100 voters is allowed
+          */
+         [[eosio::action]]
+         void claimbatch( const name& submitter, const std::vector<name>& voters );
+
+         /**
+          * Notify submitter of the per voter results of claimbatch.
+          * Must be Triggered as inline action by claimbatch()
+          *
+          * @param submitter - the submitter of claimbatch()
+          * @param results - claim result of each voter, in the order of submission
+          */
+         [[eosio::action]]
+         void claimlog( const name& submitter, const std::vector<claim_result>& results );
+
+         /**
+          * Credit the pending rewards of finished epochs to producers, anyone can submit.
+          *
+          * @param producers - the producers to credit pending rewards for
+          */
+         [[eosio::action]]
+         void flushrewards( const std::vector<name>& producers );
+
         /**
          * Notify by transfer() of xtoken contract
          *
@@ -140,9 +188,17 @@ namespace amax {
          using subvote_action = eosio::action_wrapper<"subvote"_n, &amax_reward::subvote>;
          using voteproducer_action = eosio::action_wrapper<"voteproducer"_n, &amax_reward::voteproducer>;
          using claimrewards_action = eosio::action_wrapper<"claimrewards"_n, &amax_reward::claimrewards>;
+         using claimbatch_action = eosio::action_wrapper<"claimbatch"_n, &amax_reward::claimbatch>;
+         using claimlog_action = eosio::action_wrapper<"claimlog"_n, &amax_reward::claimlog>;
+         using flushrewards_action = eosio::action_wrapper<"flushrewards"_n, &amax_reward::flushrewards>;
    public:
          struct [[eosio::table("global")]] global_state {
             asset                total_rewards  = CORE_ASSET(0);
+            // rewards accrued by voters without rewriting the producer rows and not settled into
+            // them yet, the sum of `lazy_rewards_state::producers`
+            eosio::binary_extension<asset> lazy_allocated_rewards;
+
+            EOSLIB_SERIALIZE( global_state, (total_rewards)(lazy_allocated_rewards) )
 
             typedef eosio::singleton< "global"_n, global_state >   table;
          };
@@ -155,8 +211,11 @@ namespace amax {
             name              owner;                                 // PK
             bool              is_registered        = false;          // is initialized
             asset             total_rewards        = CORE_ASSET(0);
+            // rewards not allocated to voters yet, still including the rewards kept in `lazyrwds`
+            // for this producer until its votes change
             asset             allocating_rewards   = CORE_ASSET(0);
-            asset             allocated_rewards    = CORE_ASSET(0); // = total_rewards - allocating_rewards
+            // = total_rewards - allocating_rewards
+            asset             allocated_rewards    = CORE_ASSET(0);
             asset             votes                = vote_asset_0;
             int128_t          rewards_per_vote     = 0;
             block_timestamp   update_at;
@@ -166,11 +225,51 @@ namespace amax {
             typedef eosio::multi_index< "producers"_n, producer > table;
          };
 
+         /**
+          * rewards received by producer in current epoch, not credited to rewards_per_vote yet.
+          * scope: contract self
+         */
+         struct [[eosio::table]] pending_reward {
+            name              owner;                                 // PK
+            asset             rewards              = CORE_ASSET(0);
+            uint32_t          epoch                = 0;
+
+            uint64_t primary_key()const { return owner.value; }
+
+            typedef eosio::multi_index< "pendingrwds"_n, pending_reward > table;
+         };
+
+         /**
+          * rewards voters accrued from a producer while its votes were unchanged, by producer.
+          * They are moved from `allocating_rewards` to `allocated_rewards` of the producer row
+          * the next time its votes change, so claims do not rewrite the producer rows.
+          * scope: contract self
+         */
+         struct [[eosio::table("lazyrwds")]] lazy_rewards_state {
+            std::vector<std::pair<name, asset>>    producers;     // sorted by producer name
+
+            typedef eosio::singleton< "lazyrwds"_n, lazy_rewards_state >   table;
+         };
+
          struct voted_producer_info {
             int128_t           last_rewards_per_vote         = 0;
          };
 
-         using voted_producer_map = std::map<name, voted_producer_info>;
+         /**
+          * voted producers sorted by name, a flat replacement of std::map<name, voted_producer_info>
+          * with the identical serialized layout
+          */
+         using voted_producer_map = std::vector<std::pair<name, voted_producer_info>>;
+
+         /**
+          * position of `producer` in a list of (name, value) pairs sorted by name, i.e. the first pair
+          * not less than it, check `itr->first == producer` for a match
+          */
+         template<typename Pairs>
+         static inline typename Pairs::iterator find_sorted_producer(Pairs& pairs, const name& producer) {
+            return std::lower_bound(pairs.begin(), pairs.end(), producer,
+               [](const auto& p, const name& n) { return p.first < n; });
+         }
 
          /**
           * voter table.
@@ -201,12 +300,23 @@ namespace amax {
    private:
       global_state::table     _global;
       global_state            _gstate;
+      bool                    _gstate_changed = false;
       voter::table            _voter_tbl;
       producer::table         _producer_tbl;
+      pending_reward::table   _pending_tbl;
+      lazy_rewards_state::table              _lazy_tbl;
+      std::optional<lazy_rewards_state>      _lazy;
+      bool                                   _lazy_changed = false;
 
 
       void allocate_producer_rewards(voted_producer_map& producers, const asset& votes_old, const asset& votes_delta, const name& new_payer, asset &allocated_rewards_out);
+      void accrue_voter_rewards(voted_producer_map& producers, const asset& votes, asset &allocated_rewards_out);
       void change_vote(const name& voter, const asset& votes, bool is_adding);
+      asset take_pending_rewards(const name& producer, uint32_t before_epoch);
+      void credit_rewards(producer& p, const asset& rewards);
+      lazy_rewards_state& get_lazy_rewards();
+      void add_lazy_rewards(const name& producer, const asset& rewards);
+      asset take_lazy_rewards(const name& producer);
    };
 
 }
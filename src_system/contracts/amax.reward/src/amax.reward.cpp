@@ -1,6 +1,8 @@
 #include <amax.reward/amax.reward.hpp>
 #include <eosio/system.hpp>
 
+#include <iterator>
+
 namespace amax {
 
 using namespace eosio;
@@ -56,6 +58,10 @@ inline static int128_t calc_rewards_per_vote(const int128_t& old_rewards_per_vot
    return new_rewards_per_vote;
 }
 
+inline static uint32_t current_epoch() {
+   return eosio::current_time_point().sec_since_epoch() / REWARD_EPOCH_SEC;
+}
+
 inline static asset calc_voter_rewards(const asset& votes, const int128_t& rewards_per_vote) {
    ASSERT(votes.amount >= 0 && rewards_per_vote >= 0);
    CHECK(votes.amount * rewards_per_vote >= rewards_per_vote, "calculated rewards overflow");
@@ -109,6 +115,8 @@ void amax_reward::voteproducer( const name& voter, const std::vector<name>& prod
 
       voted_producer_map added_prods;
       voted_producer_map removed_prods;
+      voted_producer_map kept_prods;
+      kept_prods.reserve(std::min(v.producers.size(), producers.size()));
 
       auto new_prod_itr = producers.begin();
       auto old_prod_itr = v.producers.begin();
@@ -117,34 +125,34 @@ void amax_reward::voteproducer( const name& voter, const std::vector<name>& prod
          if (old_prod_itr != v.producers.end() && new_prod_itr != producers.end()) {
             if ( old_prod_itr->first < (*new_prod_itr) ) {
                // old is discarded and add to removed_prods, new is processed in next loop
-               removed_prods.emplace(*old_prod_itr);
-               old_prod_itr = v.producers.erase(old_prod_itr);
+               removed_prods.push_back(*old_prod_itr++);
             }else if ( (*new_prod_itr) < old_prod_itr->first ) {
                // old is processed in next loop, new is added to added_prods
-               added_prods[*new_prod_itr] = {};
-               new_prod_itr++;
+               added_prods.emplace_back(*new_prod_itr++, voted_producer_info{});
             } else { // old_prod_itr->first == (*new_prod_itr))
                // old is keeped in v.producers, new is discarded
-               old_prod_itr++;
+               kept_prods.push_back(*old_prod_itr++);
                new_prod_itr++;
             }
          } else if (old_prod_itr != v.producers.end()) {
             // no new, old is discarded and add to removed_prods,
-            removed_prods.emplace(*old_prod_itr);
-            old_prod_itr = v.producers.erase(old_prod_itr);
+            removed_prods.push_back(*old_prod_itr++);
          } else { // new_prod_itr != producers.end()
             // no old, new is added to added_prods
-            added_prods[*new_prod_itr] = {};
-            new_prod_itr++;
+            added_prods.emplace_back(*new_prod_itr++, voted_producer_info{});
          }
       }
 
       allocate_producer_rewards(removed_prods, v.votes, -v.votes, voter, v.unclaimed_rewards);
-      allocate_producer_rewards(v.producers, v.votes, vote_asset_0, voter, v.unclaimed_rewards);
+      allocate_producer_rewards(kept_prods, v.votes, vote_asset_0, voter, v.unclaimed_rewards);
       allocate_producer_rewards(added_prods, vote_asset_0, v.votes, voter, v.unclaimed_rewards);
-      for (auto& added_prod : added_prods) {
-         v.producers.emplace(added_prod);
-      }
+
+      // both lists are sorted by name, so merging them keeps v.producers sorted
+      v.producers.clear();
+      v.producers.reserve(kept_prods.size() + added_prods.size());
+      std::merge(kept_prods.begin(), kept_prods.end(), added_prods.begin(), added_prods.end(),
+                 std::back_inserter(v.producers),
+                 [](const auto& a, const auto& b) { return a.first < b.first; });
 
       v.update_at    = now;
    });
@@ -188,27 +196,113 @@ void amax_reward::claimfor(const name& submitter, const name& voter) {
    });
 }
 
+void amax_reward::claimbatch(const name& submitter, const std::vector<name>& voters) {
+   require_auth( submitter );
+   CHECK(voters.size() <= MAX_CLAIM_BATCH, "too many voters to claim")
+
+   auto now = current_time_point();
+   std::vector<claim_result> results;
+   results.reserve(voters.size());
+   // producers found for a voter stay cached in _producer_tbl and are reused by the following voters,
+   // the global state is saved once when the action ends
+   for (const auto& voter : voters) {
+      claim_result result{ voter, CORE_ASSET(0) };
+
+      auto voter_itr = _voter_tbl.find(voter.value);
+      if (voter_itr != _voter_tbl.end() && voter_itr->votes.amount > 0) {
+         _voter_tbl.modify(voter_itr, same_payer, [&]( auto& v) {
+            allocate_producer_rewards(v.producers, v.votes, vote_asset_0, voter, v.unclaimed_rewards);
+            if (v.unclaimed_rewards.amount > 0) {
+               result.rewards = v.unclaimed_rewards;
+               v.claimed_rewards += v.unclaimed_rewards;
+               v.unclaimed_rewards.amount = 0;
+               v.update_at = now;
+            }
+         });
+         if (result.rewards.amount > 0) {
+            TRANSFER_OUT(CORE_TOKEN, voter, result.rewards, "voted rewards");
+         }
+      }
+      results.push_back(result);
+   }
+
+   claimlog_action(get_self(), {{get_self(), ACTIVE_PERM}}).send(submitter, results);
+}
+
+void amax_reward::claimlog(const name& submitter, const std::vector<claim_result>& results) {
+   require_auth( get_self() );
+   require_recipient( submitter );
+}
+
 void amax_reward::ontransfer(    const name &from,
                                  const name &to,
                                  const asset &quantity,
                                  const string &memo)
 {
    if (get_first_receiver() == CORE_TOKEN && quantity.symbol == CORE_SYMBOL && from != get_self() && to == get_self()) {
-      _gstate.total_rewards += quantity;
-      _global.set(_gstate, get_self());
-
       auto prod_itr = _producer_tbl.find(from.value);
       check(prod_itr != _producer_tbl.end(), "producer(from) not found");
       check(prod_itr->is_registered, "producer(from) not registered");
-      _producer_tbl.modify(prod_itr, same_payer, [&]( auto& p ) {
-         p.total_rewards         += quantity;
-         p.allocating_rewards   += quantity;
-         p.rewards_per_vote      = calc_rewards_per_vote(p.rewards_per_vote, quantity, p.votes);
-         p.update_at = eosio::current_time_point();
+
+      // sum up rewards of the epoch, the producer row is updated once when the epoch is over
+      uint32_t epoch = current_epoch();
+      auto pending_itr = _pending_tbl.find(from.value);
+      if (pending_itr != _pending_tbl.end() && pending_itr->epoch < epoch && pending_itr->rewards.amount > 0) {
+         auto rewards = pending_itr->rewards;
+         _producer_tbl.modify(prod_itr, same_payer, [&]( auto& p ) {
+            credit_rewards(p, rewards);
+         });
+         _pending_tbl.modify(pending_itr, same_payer, [&]( auto& r ) {
+            r.rewards = quantity;
+            r.epoch   = epoch;
+         });
+      } else {
+         db::set(_pending_tbl, pending_itr, get_self(), [&]( auto& r, bool is_new ) {
+            if (is_new) {
+               r.owner = from;
+            }
+            r.rewards += quantity;
+            r.epoch   = epoch;
+         });
+      }
+   }
+}
+
+void amax_reward::flushrewards( const std::vector<name>& producers ) {
+   uint32_t epoch = current_epoch();
+   for (const auto& producer : producers) {
+      auto rewards = take_pending_rewards(producer, epoch);
+      if (rewards.amount == 0) continue;
+
+      const auto& prod = _producer_tbl.get(producer.value, "producer not found");
+      _producer_tbl.modify(prod, same_payer, [&]( auto& p ) {
+         credit_rewards(p, rewards);
       });
    }
 }
 
+asset amax_reward::take_pending_rewards(const name& producer, uint32_t before_epoch) {
+   auto pending_itr = _pending_tbl.find(producer.value);
+   if (pending_itr == _pending_tbl.end() || pending_itr->epoch >= before_epoch || pending_itr->rewards.amount == 0)
+      return CORE_ASSET(0);
+
+   auto rewards = pending_itr->rewards;
+   _pending_tbl.modify(pending_itr, same_payer, [&]( auto& r ) {
+      r.rewards.amount = 0;
+   });
+   return rewards;
+}
+
+void amax_reward::credit_rewards(producer& p, const asset& rewards) {
+   _gstate.total_rewards += rewards;
+   _gstate_changed = true;
+
+   p.total_rewards         += rewards;
+   p.allocating_rewards    += rewards;
+   p.rewards_per_vote      = calc_rewards_per_vote(p.rewards_per_vote, rewards, p.votes);
+   p.update_at             = eosio::current_time_point();
+}
+
 void amax_reward::change_vote(const name& voter, const asset& votes, bool is_adding) {
    require_auth( SYSTEM_CONTRACT );
    require_auth( voter );
@@ -239,6 +333,12 @@ void amax_reward::change_vote(const name& voter, const asset& votes, bool is_add
 void amax_reward::allocate_producer_rewards(voted_producer_map& producers, const asset& votes_old,
          const asset& votes_delta, const name& new_payer, asset &allocated_rewards_out) {
 
+   if (votes_delta.amount == 0) {
+      // votes of producers unchanged, settle the voter side only
+      accrue_voter_rewards(producers, votes_old, allocated_rewards_out);
+      return;
+   }
+
    auto now = eosio::current_time_point();
    for ( auto& voted_prod : producers) {
       const auto& prod_name = voted_prod.first;
@@ -248,6 +348,19 @@ void amax_reward::allocate_producer_rewards(voted_producer_map& producers, const
       db::set(_producer_tbl, prod_itr, new_payer, same_payer, [&]( auto& p, bool is_new ) {
          if (is_new) {
             p.owner = prod_name;
+         } else {
+            // rewards received under the old votes must be credited before the votes change,
+            // take the whole pending, including the current epoch
+            auto pending_rewards = take_pending_rewards(prod_name, std::numeric_limits<uint32_t>::max());
+            if (pending_rewards.amount > 0) credit_rewards(p, pending_rewards);
+
+            // settle the rewards voters accrued while the votes of this producer were unchanged
+            auto lazy_rewards = take_lazy_rewards(prod_name);
+            if (lazy_rewards.amount > 0) {
+               CHECK(p.allocating_rewards >= lazy_rewards, "producer allocating rewards insufficient");
+               p.allocating_rewards -= lazy_rewards;
+               p.allocated_rewards += lazy_rewards;
+            }
          }
 
          CHECK(p.rewards_per_vote >= last_rewards_per_vote, "last_rewards_per_vote invalid");
@@ -274,4 +387,70 @@ void amax_reward::allocate_producer_rewards(voted_producer_map& producers, const
    }
 }
 
+void amax_reward::accrue_voter_rewards(voted_producer_map& producers, const asset& votes, asset &allocated_rewards_out) {
+
+   asset accrued_rewards = CORE_ASSET(0);
+   for ( auto& voted_prod : producers) {
+      auto& last_rewards_per_vote = voted_prod.second.last_rewards_per_vote; // will be updated below
+
+      auto prod_itr = _producer_tbl.find(voted_prod.first.value);
+      if (prod_itr == _producer_tbl.end()) continue; // no rewards received yet
+
+      CHECK(prod_itr->rewards_per_vote >= last_rewards_per_vote, "last_rewards_per_vote invalid");
+      int128_t rewards_per_vote_delta = prod_itr->rewards_per_vote - last_rewards_per_vote;
+      if (rewards_per_vote_delta > 0 && votes.amount > 0) {
+         ASSERT(votes <= prod_itr->votes)
+         auto new_rewards = calc_voter_rewards(votes, rewards_per_vote_delta);
+         if (new_rewards.amount > 0) {
+            add_lazy_rewards(voted_prod.first, new_rewards);
+            accrued_rewards += new_rewards;
+         }
+      }
+      last_rewards_per_vote = prod_itr->rewards_per_vote;
+   }
+
+   if (accrued_rewards.amount > 0) {
+      auto lazy_allocated_rewards = _gstate.lazy_allocated_rewards.value_or(CORE_ASSET(0)) + accrued_rewards;
+      CHECK(lazy_allocated_rewards <= _gstate.total_rewards, "allocated rewards exceed total rewards");
+      _gstate.lazy_allocated_rewards.emplace(lazy_allocated_rewards);
+      _gstate_changed = true;
+      allocated_rewards_out += accrued_rewards;
+   }
+}
+
+amax_reward::lazy_rewards_state& amax_reward::get_lazy_rewards() {
+   if (!_lazy) {
+      _lazy = _lazy_tbl.get_or_default();
+   }
+   return *_lazy;
+}
+
+void amax_reward::add_lazy_rewards(const name& producer, const asset& rewards) {
+   auto& lazy_prods = get_lazy_rewards().producers;
+   auto itr = find_sorted_producer(lazy_prods, producer);
+   if (itr != lazy_prods.end() && itr->first == producer) {
+      itr->second += rewards;
+   } else {
+      lazy_prods.emplace(itr, producer, rewards);
+   }
+   _lazy_changed = true;
+}
+
+asset amax_reward::take_lazy_rewards(const name& producer) {
+   auto& lazy_prods = get_lazy_rewards().producers;
+   auto itr = find_sorted_producer(lazy_prods, producer);
+   if (itr == lazy_prods.end() || itr->first != producer)
+      return CORE_ASSET(0);
+
+   auto rewards = itr->second;
+   lazy_prods.erase(itr);
+   _lazy_changed = true;
+
+   auto lazy_allocated_rewards = _gstate.lazy_allocated_rewards.value_or(CORE_ASSET(0)) - rewards;
+   ASSERT(lazy_allocated_rewards.amount >= 0)
+   _gstate.lazy_allocated_rewards.emplace(lazy_allocated_rewards);
+   _gstate_changed = true;
+   return rewards;
+}
+
 } /// namespace eosio
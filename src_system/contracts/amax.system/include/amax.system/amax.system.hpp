@@ -268,7 +268,7 @@ namespace eosiosystem {
       time_point           init_reward_end_time;      /// end time of initializing reward phase
       uint32_t             elected_sequence = 0;      /// elected sequence, increase 1 each time the elected queue is reinitialized
       uint32_t             reserved0 = 0;             /// reserved0
-      uint64_t             reserved1 = 0;             /// reserved1
+      uint64_t             last_producer_schedule_digest = 0; /// first 8 bytes of sha256 of the last proposed schedule
       uint8_t              revision = 0; ///< used to track version updates in the future.
 
       // explicit serialization macro is not necessary, used here only to improve compilation time
@@ -278,7 +278,7 @@ namespace eosiosystem {
                                 (total_activated_stake)(thresh_activated_stake_time)
                                 (last_producer_schedule_size)(total_producer_vote_weight)(last_name_close)
                                 (new_ram_per_block)(last_ram_increase)
-                                (init_reward_start_time)(init_reward_end_time)(elected_sequence)(reserved0)(reserved1)
+                                (init_reward_start_time)(init_reward_end_time)(elected_sequence)(reserved0)(last_producer_schedule_digest)
                                 (revision)
       )
    };
@@ -292,6 +292,16 @@ namespace eosiosystem {
       EOSLIB_SERIALIZE( producer_elected_queue, (last_producer_count)(tail)(tail_prev)(tail_next) )
    };
 
+   // Elected rank of a producer reported by `qryelected`, `rank` starts from 1 at the top of the main queue
+   struct elected_producer_rank {
+      name        producer;
+      asset       elected_votes;
+      uint32_t    rank        = 0;
+      bool        is_main     = false;
+
+      EOSLIB_SERIALIZE( elected_producer_rank, (producer)(elected_votes)(rank)(is_main) )
+   };
+
 
    struct producer_reward_info {
       asset                     total_rewards;              /// total rewards
@@ -451,6 +461,8 @@ namespace eosiosystem {
    };
 
 
+   // Voters stay in the single `get_self()` scope: rows are found by primary key, so one large scope
+   // costs the same per lookup as many small ones, and off-chain readers rely on this scope.
    typedef eosio::multi_index< "voters"_n, voter_info >  voters_table;
 
 
@@ -517,6 +529,34 @@ namespace eosiosystem {
    typedef eosio::multi_index< "refunds"_n, refund_request >      refunds_table;
    typedef eosio::multi_index< "voterefund"_n, vote_refund >      vote_refund_table;
 
+   // Pending vote refund, drained in maturity order by `processrefunds`. The primary key follows the
+   // request order and every refund has the same delay, so the table is ordered by maturity too.
+   struct [[eosio::table, eosio::contract("amax.system")]] vote_refund_queue_item {
+      uint64_t        id;
+      name            owner;
+      time_point_sec  mature_time;
+
+      uint64_t  primary_key()const { return id; }
+
+      EOSLIB_SERIALIZE( vote_refund_queue_item, (id)(owner)(mature_time) )
+   };
+
+   typedef eosio::multi_index< "refundqueue"_n, vote_refund_queue_item > vote_refund_queue_table;
+
+   // Progress of `migratevoters`, the next voter to scan and the totals of the finished batches.
+   // `ram_reclaimed` counts the bytes of erased voter rows, including the per-row overhead.
+   struct [[eosio::table("votermigrate"), eosio::contract("amax.system")]] voter_migration_state {
+      name        next_voter;
+      bool        finished       = false;
+      uint64_t    scanned        = 0;
+      uint64_t    erased         = 0;
+      uint64_t    ram_reclaimed  = 0;
+
+      EOSLIB_SERIALIZE( voter_migration_state, (next_voter)(finished)(scanned)(erased)(ram_reclaimed) )
+   };
+
+   typedef eosio::singleton< "votermigrate"_n, voter_migration_state > voter_migration_singleton;
+
    // `rex_pool` structure underlying the rex pool table. A rex pool table entry is defined by:
    // - `version` defaulted to zero,
    // - `total_lent` total amount of CORE_SYMBOL in open rex_loans
@@ -1273,6 +1313,15 @@ namespace eosiosystem {
 
          ACTION voterefund( const name& owner ) { refundvote( owner ); }
 
+         /**
+          * Process refunds action, pays up to `max` matured vote refunds from the refund queue in
+          * maturity order. Anyone can call it.
+          *
+          * @param max - the maximum number of queued refunds to process.
+          */
+         [[eosio::action]]
+         void processrefunds( uint32_t max );
+
          // functions defined in voting.cpp
 
          /**
@@ -1436,10 +1485,10 @@ namespace eosiosystem {
           * @pre Voter can only have one substracted votes at a time (including processing of delayed refunds)
           * @pre Voter can only update votes once a day, restricted actions: (addvote, subvote, vote)
           *
-          * @post The staked AMAX of substracted votes are transferred to `voter` liquid balance via a
-          *    deferred `refundvote` transaction with a delay of 3 days.
+          * @post The staked AMAX of substracted votes are queued and transferred to `voter` liquid balance
+          *    by `processrefunds` (or `refundvote`) after a delay of 3 days.
           * @post All producers `voter` account has voted for will have their votes updated immediately.
-          * @post Bandwidth and storage for the deferred transaction are billed to `voter`.
+          * @post Storage for the queued refund is billed to `voter`.
           */
          [[eosio::action]]
          void subvote( const name& voter, const asset& votes );
@@ -1579,6 +1628,19 @@ namespace eosiosystem {
          [[eosio::action]]
          void upgradevote();
 
+         /**
+          * Migrate voters action, scans up to `max` voters from where the previous call stopped.
+          * Voters without any remaining state (no votes, producers, proxy, stake, managed resources,
+          * REX balance or pending vote refund) are erased to release their RAM. Progress and reclaimed
+          * RAM are recorded in `votermigrate`.
+          *
+          * @param max - the maximum number of voters to scan.
+          *
+          * @pre The new voting strategy must be enabled by `upgradevote`
+          */
+         [[eosio::action]]
+         void migratevoters( uint32_t max );
+
          /**
           * set min producer votes
           */
@@ -1615,6 +1677,34 @@ namespace eosiosystem {
          [[eosio::action]]
          void powerup( const name& payer, const name& receiver, uint32_t days, int64_t net_frac, int64_t cpu_frac, const asset& max_payment );
 
+         /**
+          * Query powerup action, computes the fee `powerup` would charge right now for `net_frac` and
+          * `cpu_frac` without changing any state. The result is reported by an inline `powupresult`
+          * to `amax.reserv`.
+          *
+          * @param net_frac - fraction of net (100% = 10^15) managed by this market
+          * @param cpu_frac - fraction of cpu (100% = 10^15) managed by this market
+          */
+         [[eosio::action]]
+         void qrypowerup( int64_t net_frac, int64_t cpu_frac );
+
+         /**
+          * Query elected action, reports the main and backup elected queues in rank order by an inline
+          * `electedlog`, without changing any state.
+          *
+          * @param max - the maximum number of producers to report.
+          */
+         [[eosio::action]]
+         void qryelected( uint32_t max );
+
+         /**
+          * Elected log action, a no-op whose data carries the result of `qryelected` in its trace.
+          *
+          * @param producers - the elected producers in rank order
+          */
+         [[eosio::action]]
+         void electedlog( const std::vector<elected_producer_rank>& producers );
+
          using init_action = eosio::action_wrapper<"init"_n, &system_contract::init>;
          using setacctram_action = eosio::action_wrapper<"setacctram"_n, &system_contract::setacctram>;
          using setacctnet_action = eosio::action_wrapper<"setacctnet"_n, &system_contract::setacctnet>;
@@ -1666,6 +1756,7 @@ namespace eosiosystem {
          using cfgpowerup_action = eosio::action_wrapper<"cfgpowerup"_n, &system_contract::cfgpowerup>;
          using powerupexec_action = eosio::action_wrapper<"powerupexec"_n, &system_contract::powerupexec>;
          using powerup_action = eosio::action_wrapper<"powerup"_n, &system_contract::powerup>;
+         using electedlog_action = eosio::action_wrapper<"electedlog"_n, &system_contract::electedlog>;
 
       private:
          //defined in amax.system.cpp
@@ -404,4 +404,52 @@ void system_contract::powerup(const name& payer, const name& receiver, uint32_t
    powupresult_act.send( fee, net_amount, cpu_amount );
 }
 
+void system_contract::qrypowerup(int64_t net_frac, int64_t cpu_frac) {
+   powerup_state_singleton state_sing{ get_self(), 0 };
+   powerup_order_table     orders{ get_self(), 0 };
+   eosio::check(state_sing.exists(), "powerup hasn't been initialized");
+   auto           state       = state_sing.get();
+   time_point_sec now         = eosio::current_time_point();
+   auto           core_symbol = this->core_symbol();
+   eosio::check(net_frac >= 0, "net_frac can't be negative");
+   eosio::check(cpu_frac >= 0, "cpu_frac can't be negative");
+   eosio::check(net_frac <= powerup_frac, "net can't be more than 100%");
+   eosio::check(cpu_frac <= powerup_frac, "cpu can't be more than 100%");
+
+   // same as process_powerup_queue with the 2 items processed by `powerup`, applied to the copy of state only
+   update_utilization(now, state.net);
+   update_utilization(now, state.cpu);
+   int64_t net_delta_available = 0;
+   int64_t cpu_delta_available = 0;
+   auto    idx                 = orders.get_index<"byexpires"_n>();
+   auto    it                  = idx.begin();
+   for (uint32_t i = 0; i < 2 && it != idx.end() && it->expires <= now; ++i, ++it) {
+      net_delta_available += it->net_weight;
+      cpu_delta_available += it->cpu_weight;
+   }
+   state.net.utilization -= net_delta_available;
+   state.cpu.utilization -= cpu_delta_available;
+   update_weight(now, state.net, net_delta_available);
+   update_weight(now, state.cpu, cpu_delta_available);
+
+   eosio::asset fee{ 0, core_symbol };
+   auto         process = [&](int64_t frac, int64_t& amount, powerup_state_resource& state) {
+      if (!frac)
+         return;
+      amount = int128_t(frac) * state.weight / powerup_frac;
+      eosio::check(state.weight, "market doesn't have resources available");
+      eosio::check(state.utilization + amount <= state.weight, "market doesn't have enough resources available");
+      fee.amount += calc_powerup_fee(state, amount);
+   };
+
+   int64_t net_amount = 0;
+   int64_t cpu_amount = 0;
+   process(net_frac, net_amount, state.net);
+   process(cpu_frac, cpu_amount, state.cpu);
+
+   // inline noop action
+   powup_results::powupresult_action powupresult_act{ reserv_account, std::vector<eosio::permission_level>{ } };
+   powupresult_act.send( fee, net_amount, cpu_amount );
+}
+
 } // namespace eosiosystem
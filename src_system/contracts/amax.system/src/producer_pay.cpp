@@ -41,19 +41,49 @@ namespace eosiosystem {
       return asset(calc_halving_rewards_per_block( amount >=0 ? amount : 0), reward_info.total_rewards.symbol);
    }
 
+   /**
+    * Scan the remaining block header fields of onblock in place, skipping the fixed-size fields and
+    * every header extension except the backup block extension, so the extensions are never copied.
+    */
+   template<typename DataStream>
+   void scan_backup_block_extension(DataStream& ds, backup_block_extension& bbe) {
+      // confirmed, previous, transaction_mroot, action_mroot, schedule_version
+      ds.skip( sizeof(uint16_t) + 3 * sizeof(checksum256) + sizeof(uint32_t) );
+
+      bool has_new_producers = false;
+      ds >> has_new_producers;
+      if (has_new_producers) {
+         // only present when a schedule is proposed, keys are variable-size so decode it
+         eosio::producer_schedule new_producers;
+         ds >> new_producers;
+      }
+
+      eosio::unsigned_int ext_count;
+      ds >> ext_count;
+      for( uint32_t i = 0; i < ext_count.value; ++i ) {
+         uint16_t id = 0;
+         eosio::unsigned_int ext_size;
+         ds >> id >> ext_size;
+         if (id == backup_block_extension::extension_id()) {
+            eosio::datastream<const char*> ext_ds( ds.pos(), ext_size.value );
+            ext_ds >> bbe;
+         }
+         ds.skip( ext_size.value );
+      }
+   }
+
    void system_contract::onblock( ignore<block_header> ) {
       using namespace eosio;
 
       require_auth(get_self());
 
-      block_header bh;
-      block_timestamp& timestamp = bh.timestamp;
-      name& producer = bh.producer;
+      block_timestamp timestamp;
+      name producer;
+      _ds >> timestamp >> producer;
 
+      backup_block_extension bbe;
       if (_elect_gstate.is_bbp_enabled()) {
-         _ds >> bh;
-      } else {
-         _ds >> timestamp >> producer;
+         scan_backup_block_extension(_ds, bbe);
       }
 
       /** until activation, no new rewards are paid */
@@ -69,30 +99,22 @@ namespace eosiosystem {
          auto& main_reward_info              = _elect_gstate.main_reward_info;
          auto& backup_reward_info         = _elect_gstate.backup_reward_info;
 
-         if (ct >= _gstate.init_reward_end_time) {
+         // period `n` (n >= 1) starts at init_reward_end_time + (n - 1) * reward_halving_period_seconds, compare
+         // with the start of the period following `halving_period_num` instead of dividing on every block
+         const auto next_period_start = _gstate.init_reward_end_time + eosio::seconds(_elect_gstate.halving_period_num * reward_halving_period_seconds);
+         if (ct >= next_period_start) {
             int64_t cur_period_num = 1 + (ct - _gstate.init_reward_end_time).to_seconds() / reward_halving_period_seconds;
-            ASSERT(cur_period_num >= _elect_gstate.halving_period_num)
-            if (cur_period_num > _elect_gstate.halving_period_num) {
-               _elect_gstate.halving_period_num = cur_period_num;
-               main_reward_info.rewards_per_block = calc_halving_rewards_per_block(main_reward_info);
-               if (_elect_gstate.is_bbp_enabled()) {
-                  backup_reward_info.rewards_per_block = calc_halving_rewards_per_block(backup_reward_info);
-               }
+            ASSERT(cur_period_num > _elect_gstate.halving_period_num)
+            _elect_gstate.halving_period_num = cur_period_num;
+            main_reward_info.rewards_per_block = calc_halving_rewards_per_block(main_reward_info);
+            if (_elect_gstate.is_bbp_enabled()) {
+               backup_reward_info.rewards_per_block = calc_halving_rewards_per_block(backup_reward_info);
             }
          }
 
          inc_producer_rewards(producer, main_reward_info);
 
          if (_elect_gstate.is_bbp_enabled() && (backup_reward_info.rewards_per_block.amount > 0) ) {
-            backup_block_extension bbe;
-            for( size_t i = 0; i < bh.header_extensions.size(); ++i ) {
-               const auto& e = bh.header_extensions[i];
-               auto id = e.first;
-               if (id == backup_block_extension::extension_id()) {
-                  datastream<const char*> ext_ds( e.second.data(), e.second.size() );
-                  ext_ds >> bbe;
-               }
-            }
             if (!bbe.is_backup && bbe.previous_backup
                   && bbe.previous_backup->contribution >= _elect_gstate.min_backup_reward_contribution) {
 
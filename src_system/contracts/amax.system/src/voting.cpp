@@ -226,6 +226,77 @@ namespace eosiosystem {
       _gstate.last_producer_schedule_update = ct;
    }
 
+   void system_contract::migratevoters( uint32_t max ) {
+      check( has_auth( get_self() ) || has_auth( producer_admin ), "missing authority" );
+      CHECK( _elect_gstate.is_init(), "new voting strategy must be enabled first" )
+      CHECK( max > 0, "max must be positive" )
+
+      voter_migration_singleton migration( get_self(), get_self().value );
+      auto state = migration.get_or_default();
+      CHECK( !state.finished, "voter migration is finished" )
+
+      // billable RAM overhead of a table row, besides its packed data
+      static constexpr uint64_t row_overhead_bytes = 108;
+      const auto now = current_time_point();
+      auto itr = _voters.lower_bound( state.next_voter.value );
+      for( uint32_t scanned = 0; itr != _voters.end() && scanned < max; ++scanned ) {
+         const auto& v = *itr;
+         ++state.scanned;
+         bool is_empty = v.votes.amount == 0 && v.producers.empty() && !v.proxy && !v.is_proxy
+                      && v.staked == 0 && v.proxied_vote_weight == 0 && v.flags1 == 0
+                      && time_point(v.last_unvoted_time) + seconds(vote_interval_sec) < now
+                      && _rexbalance.find( v.owner.value ) == _rexbalance.end();
+         if( is_empty ) {
+            // the votes of a pending refund are still owed to the voter
+            vote_refund_table vote_refund_tbl( get_self(), v.owner.value );
+            is_empty = vote_refund_tbl.find( v.owner.value ) == vote_refund_tbl.end();
+         }
+         if( is_empty ) {
+            state.ram_reclaimed += eosio::pack_size( v ) + row_overhead_bytes;
+            ++state.erased;
+            itr = _voters.erase( itr );
+         } else {
+            ++itr;
+         }
+      }
+
+      if( itr == _voters.end() ) {
+         state.next_voter = name();
+         state.finished = true;
+      } else {
+         state.next_voter = itr->owner;
+      }
+      migration.set( state, get_self() );
+   }
+
+   void system_contract::qryelected( uint32_t max ) {
+      CHECK( _elect_gstate.is_init(), "new voting strategy is not enabled" )
+      CHECK( max > 0, "max must be positive" )
+
+      const uint32_t main_count  = _elect_gstate.main_elected_queue.last_producer_count;
+      const uint32_t total_count = main_count + _elect_gstate.backup_elected_queue.last_producer_count;
+      const uint32_t count       = std::min( max, total_count );
+
+      std::vector<elected_producer_rank> producers;
+      producers.reserve( count );
+      auto elect_idx = _producers.get_index<"electedprod"_n>();
+      for( auto it = elect_idx.cbegin(); it != elect_idx.cend() && producers.size() < count; ++it ) {
+         const auto votes = it->get_elected_votes();
+         if (!it->active() || !is_prod_votes_valid(votes)) {
+            break;
+         }
+         const uint32_t rank = producers.size() + 1;
+         producers.push_back( elected_producer_rank{ it->owner, votes, rank, rank <= main_count } );
+      }
+
+      electedlog_action electedlog_act{ get_self(), { {get_self(), active_permission} } };
+      electedlog_act.send( producers );
+   }
+
+   void system_contract::electedlog( const std::vector<elected_producer_rank>& producers ) {
+      require_auth( get_self() );
+   }
+
    void system_contract::setmprodvote(const asset& min_producer_votes) {
       // require_auth( get_self() );
       check( has_auth( get_self() ) || has_auth( producer_admin ), "missing authority" );
@@ -261,6 +332,7 @@ namespace eosiosystem {
 
          _gstate.elected_sequence++;
          _gstate.last_producer_schedule_update = current_block_time();
+         _gstate.last_producer_schedule_digest = 0; // the schedule is managed by producer changes from now on
       }
 
       _gstate.total_producer_vote_weight = 0; // clear the old vote info
@@ -285,6 +357,8 @@ namespace eosiosystem {
       backup_changes.producer_count = min_backup_producer_count;
       beq.last_producer_count       = min_backup_producer_count;
 
+      // The walk is bounded by max_main_producer_count + min_backup_producer_count + 1 rows whatever
+      // max_backup_producer_count is, the backup queue then grows by the incremental producer changes.
       // TODO: need using location to order producers?
       for( auto it = elect_idx.cbegin(); it != elect_idx.cend(); ++it ) {
          auto elected_info = it->get_elected_info();
@@ -476,51 +550,53 @@ namespace eosiosystem {
 
    bool system_contract::update_elected_producers( const block_timestamp& block_time ) {
 
-
-      using value_type = std::pair<eosio::producer_authority, uint16_t>;
-
-      auto fetch_top_producers = [&](std::vector< value_type > &top_producers, const auto& idx, const auto& is_valid) {
+      auto fetch_top_producers = [&](std::vector< eosio::producer_authority > &top_producers, const auto& idx, const auto& is_valid) {
 
          for( auto it = idx.cbegin(); it != idx.cend() && top_producers.size() < 21 && it->active() && is_valid(*it); ++it ) {
             top_producers.emplace_back(
                eosio::producer_authority{
                   .producer_name = it->owner,
                   .authority     = it->producer_authority
-               },
-               it->location
+               }
             );
          }
       };
 
-      std::vector< value_type > top_producers;
-      top_producers.reserve(21);
+      std::vector< eosio::producer_authority > producers;
+      producers.reserve(21);
       if(_elect_gstate.is_init()) {
-         fetch_top_producers(top_producers, _producers.get_index<"electedprod"_n>(), [&](const auto& prod)->bool {
+         fetch_top_producers(producers, _producers.get_index<"electedprod"_n>(), [&](const auto& prod)->bool {
             return is_prod_votes_valid(prod.get_elected_votes());
          });
       } else {
-         fetch_top_producers(top_producers, _producers.get_index<"prototalvote"_n>(), [](const auto& prod)->bool {
+         fetch_top_producers(producers, _producers.get_index<"prototalvote"_n>(), [](const auto& prod)->bool {
             return prod.total_votes > 0;
          });
       }
 
-      if ( top_producers.size() == 0 || top_producers.size() < _gstate.last_producer_schedule_size ) {
+      if ( producers.size() == 0 || producers.size() < _gstate.last_producer_schedule_size ) {
          return false;
       }
 
-      std::sort( top_producers.begin(), top_producers.end(), []( const value_type& lhs, const value_type& rhs ) {
-         return lhs.first.producer_name < rhs.first.producer_name; // sort by producer name
-         // return lhs.second < rhs.second; // sort by location
+      std::sort( producers.begin(), producers.end(), []( const auto& lhs, const auto& rhs ) {
+         return lhs.producer_name < rhs.producer_name; // sort by producer name
       } );
 
-      std::vector<eosio::producer_authority> producers;
-
-      producers.reserve(top_producers.size());
-      for( auto& item : top_producers )
-         producers.push_back( std::move(item.first) );
+      // most minutes the top producers and their authorities are unchanged, skip proposing the same schedule again
+      auto packed_producers = eosio::pack( producers );
+      auto hash = eosio::sha256( packed_producers.data(), packed_producers.size() ).extract_as_byte_array();
+      uint64_t digest = 0;
+      for( size_t i = 0; i < sizeof(digest); ++i ) {
+         digest = (digest << 8) | hash[i];
+      }
+      if ( digest == _gstate.last_producer_schedule_digest ) {
+         return false;
+      }
 
+      // the digest only tracks a schedule the native system accepted, a failed proposal is retried next time
       if( set_proposed_producers( producers ) >= 0 ) {
-         _gstate.last_producer_schedule_size = static_cast<decltype(_gstate.last_producer_schedule_size)>( top_producers.size() );
+         _gstate.last_producer_schedule_size = static_cast<decltype(_gstate.last_producer_schedule_size)>( producers.size() );
+         _gstate.last_producer_schedule_digest = digest;
          return true;
       }
 
@@ -550,9 +626,11 @@ namespace eosiosystem {
          }
       }
       if (rows > 0) {
-         bool need_erasing;
+         bool need_erasing = false;
          if (changes.get_change_size() > 0) {
             need_erasing = eosio::set_proposed_producers(changes) > 0;
+            // the proposed schedule is changed here, so the next full schedule must not be skipped by its digest
+            if (need_erasing) _gstate.last_producer_schedule_digest = 0;
          }
          if (need_erasing) {
             auto itr = _elected_changes.begin();
@@ -811,14 +889,12 @@ namespace eosiosystem {
       amax_reward::subvote_action subvote_act{ reward_account, { {get_self(), active_permission}, {voter, active_permission} } };
       subvote_act.send( voter, votes );
 
-      static const name act_name = "refundvote"_n;
-      uint128_t trx_send_id = uint128_t(act_name.value) << 64 | voter.value;
-      eosio::transaction refund_trx;
-      auto pl = permission_level{ voter, active_permission };
-      refund_trx.actions.emplace_back( pl, _self, act_name, voter );
-      refund_trx.delay_sec = refund_delay_sec;
-      refund_trx.send( trx_send_id, voter, true );
-
+      vote_refund_queue_table refund_queue( get_self(), get_self().value );
+      refund_queue.emplace( voter, [&]( auto& q ) {
+         q.id           = refund_queue.available_primary_key();
+         q.owner        = voter;
+         q.mature_time  = time_point_sec(now) + refund_delay_sec;
+      });
    }
 
    //  void system_contract::addproducers( const name& voter, const std::vector<name>& producers );
@@ -900,6 +976,27 @@ namespace eosiosystem {
       vote_refund_tbl.erase( itr );
    }
 
+   void system_contract::processrefunds( uint32_t max ) {
+      CHECK( max > 0, "max must be positive" )
+
+      const auto now = current_time_point();
+      vote_refund_queue_table refund_queue( get_self(), get_self().value );
+      token::transfer_action transfer_act{ token_account, { {vote_account, active_permission} } };
+      uint32_t processed = 0;
+      for( auto qitr = refund_queue.begin(); qitr != refund_queue.end() && qitr->mature_time <= now && processed < max; ++processed ) {
+         // the refund may have been claimed by `refundvote` already, or replaced by a later subvote
+         // that is queued behind this item, only a matured refund is paid here
+         vote_refund_table vote_refund_tbl( get_self(), qitr->owner.value );
+         auto ritr = vote_refund_tbl.find( qitr->owner.value );
+         if( ritr != vote_refund_tbl.end() && ritr->request_time + seconds(refund_delay_sec) <= now ) {
+            transfer_act.send( vote_account, ritr->owner, vote_to_core_asset(ritr->votes), "refundvote" );
+            vote_refund_tbl.erase( ritr );
+         }
+         qitr = refund_queue.erase( qitr );
+      }
+      CHECK( processed > 0, "no matured vote refund" )
+   }
+
    void system_contract::regproxy( const name& proxy, bool isproxy ) {
       check(false, "regproxy is unsupported");
       require_auth( proxy );
@@ -923,6 +1020,8 @@ namespace eosiosystem {
       }
    }
 
+   // Only reached for proxies registered before `regproxy` and proxied `voteproducer` were disabled,
+   // no new delegators can join a proxy, so the propagation is kept eager rather than deferred.
    void system_contract::propagate_weight_change( const voter_info& voter, const name& payer ) {
       check( !voter.proxy || !voter.is_proxy, "account registered as a proxy is not allowed to use a proxy" );
       double new_weight          = stake2vote( voter.staked );
@@ -930,8 +1029,6 @@ namespace eosiosystem {
          new_weight              += voter.proxied_vote_weight;
       }
 
-      auto elect_idx = _producers.get_index<"electedprod"_n>();
-
       /// don't propagate small changes (1 ~= epsilon)
       if ( fabs( new_weight - voter.last_vote_weight ) > 1 )  {
          if ( voter.proxy ) {
@@ -946,7 +1043,6 @@ namespace eosiosystem {
             propagate_weight_change( proxy, payer );
          } else {
             auto delta                       = new_weight - voter.last_vote_weight;
-            const auto ct                    = current_time_point();
             for ( auto acnt : voter.producers ) {
                auto& prod = _producers.get( acnt.value, "producer not found" ); //data corruption
                _producers.modify( prod, same_payer, [&]( auto& p ) {
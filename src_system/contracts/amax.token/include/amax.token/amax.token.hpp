@@ -125,6 +125,38 @@ namespace eosio {
          [[eosio::action]]
          void blacklist( const std::vector<name>& targets, const bool& to_add );
 
+         /**
+          * Seeds the holder statistics of a token created before the `holderstats` table existed.
+          * Counters are taken from an off-chain snapshot of the `accounts` scopes; from then on
+          * `add_balance`, `sub_balance`, `open` and `close` maintain them incrementally. The snapshot must
+          * match the balances when the action executes, a symbol can only be seeded once.
+          *
+          * @param sym - the token symbol,
+          * @param holders - number of `accounts` rows of the symbol,
+          * @param nonzero_holders - number of those rows with a positive balance,
+          * @param histogram - per log2 bucket count of positive balances, see `holder_stats`.
+          */
+         [[eosio::action]]
+         void initholders( const symbol& sym, const uint64_t& holders, const uint64_t& nonzero_holders,
+                           const std::vector<uint64_t>& histogram );
+
+         static constexpr uint8_t holder_histogram_buckets = 64;
+
+         /**
+          * Holder statistics of a token, one row per symbol, scoped to the symbol code like `stat`.
+          * `histogram[i]` counts positive balances whose amount lies in [2^i, 2^(i+1)).
+          */
+         struct [[eosio::table]] holder_stats {
+            symbol                  sym;
+            uint64_t                holders           = 0;
+            uint64_t                nonzero_holders   = 0;
+            std::vector<uint64_t>   histogram;
+
+            uint64_t primary_key()const { return sym.code().raw(); }
+         };
+
+         typedef eosio::multi_index< "holderstats"_n, holder_stats > holderstats;
+
          static asset get_supply( const name& token_contract_account, const symbol_code& sym_code )
          {
             stats statstable( token_contract_account, sym_code.raw() );
@@ -139,6 +171,12 @@ namespace eosio {
             return ac.balance;
          }
 
+         static holder_stats get_holder_stats( const name& token_contract_account, const symbol_code& sym_code )
+         {
+            holderstats hstats( token_contract_account, sym_code.raw() );
+            return hstats.get( sym_code.raw(), "holder stats not tracked for symbol" );
+         }
+
          inline static bool is_blacklisted( const name& target, const name& token_contract ) {
             return _is_blacklisted( target, token_contract );
          }
@@ -149,6 +187,7 @@ namespace eosio {
          using transfer_action = eosio::action_wrapper<"transfer"_n, &token::transfer>;
          using open_action = eosio::action_wrapper<"open"_n, &token::open>;
          using close_action = eosio::action_wrapper<"close"_n, &token::close>;
+         using initholders_action = eosio::action_wrapper<"initholders"_n, &token::initholders>;
       
       private:
       
@@ -188,6 +227,7 @@ namespace eosio {
 
          void sub_balance( const name& owner, const asset& value );
          void add_balance( const name& owner, const asset& value, const name& ram_payer );
+         void update_holder_stats( const symbol& sym, int64_t old_amount, int64_t new_amount, int8_t holder_delta );
    };
 
 }
@@ -2,6 +2,10 @@
 
 namespace eosio {
 
+static inline uint8_t holder_bucket( int64_t amount ) {
+   return 63 - __builtin_clzll( static_cast<uint64_t>(amount) );
+}
+
 void token::create( const name&   issuer,
                     const asset&  maximum_supply )
 {
@@ -22,6 +26,12 @@ void token::create( const name&   issuer,
        s.max_supply    = maximum_supply;
        s.issuer        = issuer;
     });
+
+    holderstats hstats( get_self(), sym.code().raw() );
+    hstats.emplace( get_self(), [&]( auto& h ) {
+       h.sym       = sym;
+       h.histogram.assign( holder_histogram_buckets, 0 );
+    });
 }
 
 
@@ -87,6 +97,7 @@ void token::slashblack( const name& target, const asset& quantity, const string&
    from_acnts.modify( from, same_payer, [&]( auto& a ) {
       a.balance -= quantity;
    });
+   update_holder_stats( quantity.symbol, from.balance.amount + quantity.amount, from.balance.amount, 0 );
 
 
    stats statstable( get_self(), sym.code().raw() );
@@ -195,6 +206,7 @@ void token::sub_balance( const name& owner, const asset& value ) {
    from_acnts.modify( from, owner, [&]( auto& a ) {
       a.balance -= value;
    });
+   update_holder_stats( value.symbol, from.balance.amount + value.amount, from.balance.amount, 0 );
 }
 
 void token::add_balance( const name& owner, const asset& value, const name& ram_payer )
@@ -205,13 +217,70 @@ void token::add_balance( const name& owner, const asset& value, const name& ram_
       to_acnts.emplace( ram_payer, [&]( auto& a ){
         a.balance = value;
       });
+      update_holder_stats( value.symbol, 0, value.amount, 1 );
    } else {
       to_acnts.modify( to, same_payer, [&]( auto& a ) {
         a.balance += value;
       });
+      update_holder_stats( value.symbol, to->balance.amount - value.amount, to->balance.amount, 0 );
    }
 }
 
+void token::update_holder_stats( const symbol& sym, int64_t old_amount, int64_t new_amount, int8_t holder_delta )
+{
+   bool was_holding = old_amount > 0;
+   bool is_holding  = new_amount > 0;
+   // a balance staying within the same log2 bucket leaves every counter untouched
+   if( holder_delta == 0 && was_holding == is_holding &&
+       ( !is_holding || holder_bucket(old_amount) == holder_bucket(new_amount) ) )
+      return;
+
+   holderstats hstats( get_self(), sym.code().raw() );
+   auto itr = hstats.find( sym.code().raw() );
+   if( itr == hstats.end() )
+      return; // legacy symbol, not tracked until seeded by `initholders`
+
+   hstats.modify( itr, same_payer, [&]( auto& h ) {
+      check( holder_delta >= 0 || h.holders > 0, "holder stats underflow" );
+      h.holders += holder_delta;
+      if( was_holding ) {
+         auto& bucket = h.histogram[ holder_bucket(old_amount) ];
+         check( h.nonzero_holders > 0 && bucket > 0, "holder stats underflow" );
+         h.nonzero_holders--;
+         bucket--;
+      }
+      if( is_holding ) {
+         h.nonzero_holders++;
+         h.histogram[ holder_bucket(new_amount) ]++;
+      }
+   });
+}
+
+void token::initholders( const symbol& sym, const uint64_t& holders, const uint64_t& nonzero_holders,
+                         const std::vector<uint64_t>& histogram )
+{
+   require_auth( get_self() );
+
+   stats statstable( get_self(), sym.code().raw() );
+   const auto& st = statstable.get( sym.code().raw(), "symbol does not exist" );
+   check( st.supply.symbol == sym, "symbol precision mismatch" );
+   check( nonzero_holders <= holders, "nonzero holders exceed holders" );
+   check( histogram.size() == holder_histogram_buckets, "histogram size mismatch" );
+
+   uint64_t bucketed = 0;
+   for( auto count : histogram ) bucketed += count;
+   check( bucketed == nonzero_holders, "histogram does not sum to nonzero holders" );
+
+   holderstats hstats( get_self(), sym.code().raw() );
+   check( hstats.find( sym.code().raw() ) == hstats.end(), "holder stats already tracked for symbol" );
+   hstats.emplace( get_self(), [&]( auto& h ) {
+      h.sym             = sym;
+      h.holders         = holders;
+      h.nonzero_holders = nonzero_holders;
+      h.histogram       = histogram;
+   });
+}
+
 void token::open( const name& owner, const symbol& symbol, const name& ram_payer )
 {
    require_auth( ram_payer );
@@ -229,6 +298,7 @@ void token::open( const name& owner, const symbol& symbol, const name& ram_payer
       acnts.emplace( ram_payer, [&]( auto& a ){
         a.balance = asset{0, symbol};
       });
+      update_holder_stats( symbol, 0, 0, 1 );
    }
 }
 
@@ -240,6 +310,7 @@ void token::close( const name& owner, const symbol& symbol )
    check( it != acnts.end(), "Balance row already deleted or never existed. Action won't have any effect." );
    check( it->balance.amount == 0, "Cannot close because the balance is not zero." );
    acnts.erase( it );
+   update_holder_stats( symbol, 0, 0, -1 );
 }
 
 } /// namespace eosio
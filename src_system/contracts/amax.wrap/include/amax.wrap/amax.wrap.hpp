@@ -1,16 +1,23 @@
 #pragma once
 
+#include <eosio/crypto.hpp>
 #include <eosio/eosio.hpp>
 #include <eosio/ignore.hpp>
+#include <eosio/privileged.hpp>
+#include <eosio/singleton.hpp>
 #include <eosio/transaction.hpp>
 
+#include <optional>
+
 namespace eosio {
    /**
     * The `amax.wrap` system contract allows block producers to bypass authorization checks or run privileged actions with 15/21 producer approval and thus simplifies block producers superuser actions. It also makes these actions easier to audit.
     *
     * It does not give block producers any additional powers or privileges that do not already exist within the AMAX based blockchains. As it is implemented, in an AMAX based blockchain, 15/21 block producers can change an account's permissions or modify an account's contract code if they decided it is beneficial for the blockchain and community. However, the current method is opaque and leaves undesirable side effects on specific system accounts, and thus the `amax.wrap `contract solves this matter by providing an easier method of executing important governance actions.
     *
-    * The only action implemented by the `amax.wrap` system contract is the `exec` action. This action allows for execution of a transaction, which is passed to the `exec` method in the form of a packed transaction in json format via the 'trx' parameter and the `executer` account that executes the transaction. The same `executer` account will also be used to pay the RAM and CPU fees needed to execute the transaction.
+    * The `exec` action allows for execution of a transaction, which is passed to the `exec` method in the form of a packed transaction in json format via the 'trx' parameter and the `executer` account that executes the transaction. The same `executer` account will also be used to pay the RAM and CPU fees needed to execute the transaction. The `execbatch` action queues several transactions at once.
+    *
+    * Every wrapped transaction is recorded in the `pendingexec` table under a unique id taken from a counter, which is also the sender id of its deferred transaction. The row is removed when the transaction executes, when it is cancelled with `cancelexec`, or by `pruneexec` once it has expired. A row expires with its deferred transaction, i.e. after the transaction delay plus the deferred expiration window of the chain, so the row of a failed transaction is pruned too; the header expiration of the wrapped transaction is ignored by the chain, as before.
     */
    class [[eosio::contract("amax.wrap")]] wrap : public contract {
       public:
@@ -33,6 +40,81 @@ namespace eosio {
          [[eosio::action]]
          void exec( ignore<name> executer, ignore<transaction> trx );
 
+         /**
+          * Execute batch action.
+          *
+          * Queue several packed transactions for execution while bypassing regular authorization checks,
+          * each one gets its own id in the `pendingexec` table.
+          *
+          * Preconditions:
+          * - Requires authorization of amax.wrap which needs to be a privileged account.
+          * - None of the transactions is expired or already pending.
+          *
+          * Postconditions:
+          * - Deferred transactions and queue rows RAM usage is billed to 'executer'
+          *
+          * @param executer - account executing the transactions,
+          * @param trxs - the packed transactions to be executed.
+          */
+         [[eosio::action]]
+         void execbatch( name executer, const std::vector<std::vector<char>>& trxs );
+
+         /**
+          * Cancel execution action.
+          *
+          * Cancel a pending wrapped transaction and remove it from the queue.
+          *
+          * @param id - id of the pending execution.
+          */
+         [[eosio::action]]
+         void cancelexec( uint64_t id );
+
+         /**
+          * Dequeue action, appended to every wrapped transaction to remove its queue row when it executes.
+          *
+          * @param id - id of the pending execution.
+          */
+         [[eosio::action]]
+         void dequeue( uint64_t id );
+
+         /**
+          * Prune execution action, removes up to `max_rows` expired queue rows, anyone can call it.
+          *
+          * @param max_rows - maximum number of rows to remove.
+          */
+         [[eosio::action]]
+         void pruneexec( uint32_t max_rows );
+
          using exec_action = eosio::action_wrapper<"exec"_n, &wrap::exec>;
+         using execbatch_action = eosio::action_wrapper<"execbatch"_n, &wrap::execbatch>;
+         using cancelexec_action = eosio::action_wrapper<"cancelexec"_n, &wrap::cancelexec>;
+         using dequeue_action = eosio::action_wrapper<"dequeue"_n, &wrap::dequeue>;
+         using pruneexec_action = eosio::action_wrapper<"pruneexec"_n, &wrap::pruneexec>;
+
+      private:
+         struct [[eosio::table("wrapstate"), eosio::contract("amax.wrap")]] wrap_state {
+            uint64_t          next_id = 1;
+         };
+         typedef eosio::singleton< "wrapstate"_n, wrap_state > wrap_state_singleton;
+
+         struct [[eosio::table, eosio::contract("amax.wrap")]] pending_exec {
+            uint64_t          id;
+            name              executer;
+            time_point_sec    expiration;
+            checksum256       trx_hash;
+
+            uint64_t primary_key()const { return id; }
+            checksum256 by_trx_hash()const { return trx_hash; }
+            uint64_t by_expiry()const { return expiration.sec_since_epoch(); }
+         };
+         typedef eosio::multi_index< "pendingexec"_n, pending_exec,
+            indexed_by<"bytrxhash"_n, const_mem_fun<pending_exec, checksum256, &pending_exec::by_trx_hash> >,
+            indexed_by<"byexpiry"_n, const_mem_fun<pending_exec, uint64_t, &pending_exec::by_expiry> >
+         > pending_execs;
+
+         void queue_exec( wrap_state& state, name executer, const char* trx_pos, size_t trx_size );
+         time_point_sec deferred_expiration( const transaction& trx );
+
+         std::optional<uint32_t> _deferred_expiration_window;
    };
 } /// namespace eosio
@@ -10,7 +10,85 @@ void wrap::exec( ignore<name>, ignore<transaction> ) {
 
    require_auth( executer );
 
-   send_deferred( (uint128_t(executer.value) << 64) | (uint64_t)current_time_point().time_since_epoch().count(), executer, _ds.pos(), _ds.remaining() );
+   wrap_state_singleton state_sgl( get_self(), get_self().value );
+   auto state = state_sgl.get_or_default();
+   queue_exec( state, executer, _ds.pos(), _ds.remaining() );
+   state_sgl.set( state, executer );
+}
+
+void wrap::execbatch( name executer, const std::vector<std::vector<char>>& trxs ) {
+   require_auth( get_self() );
+   require_auth( executer );
+   check( !trxs.empty(), "no transaction to execute" );
+
+   wrap_state_singleton state_sgl( get_self(), get_self().value );
+   auto state = state_sgl.get_or_default();
+   for( const auto& trx : trxs ) {
+      queue_exec( state, executer, trx.data(), trx.size() );
+   }
+   state_sgl.set( state, executer );
+}
+
+void wrap::queue_exec( wrap_state& state, name executer, const char* trx_pos, size_t trx_size ) {
+   auto trx_hash = sha256( trx_pos, trx_size );
+   auto trx = unpack<transaction>( trx_pos, trx_size );
+
+   pending_execs pending( get_self(), get_self().value );
+   auto hash_idx = pending.get_index<"bytrxhash"_n>();
+   check( hash_idx.find( trx_hash ) == hash_idx.end(), "transaction is already pending" );
+
+   const uint64_t id = state.next_id++;
+   pending.emplace( executer, [&]( auto& p ) {
+      p.id           = id;
+      p.executer     = executer;
+      p.expiration   = deferred_expiration( trx );
+      p.trx_hash     = trx_hash;
+   });
+
+   trx.actions.emplace_back( permission_level{ get_self(), "active"_n }, get_self(), "dequeue"_n, id );
+   trx.send( id, executer );
+}
+
+//the chain ignores the header expiration of a deferred transaction, it expires once the deferred
+//expiration window has passed after its delay, and a failed one never runs `dequeue`
+time_point_sec wrap::deferred_expiration( const transaction& trx ) {
+   if( !_deferred_expiration_window ) {
+      blockchain_parameters params;
+      get_blockchain_parameters( params );
+      _deferred_expiration_window = params.deferred_trx_expiration_window;
+   }
+   return time_point_sec(current_time_point()) + trx.delay_sec.value + *_deferred_expiration_window;
+}
+
+void wrap::cancelexec( uint64_t id ) {
+   require_auth( get_self() );
+
+   pending_execs pending( get_self(), get_self().value );
+   const auto& p = pending.get( id, "pending execution not found" );
+   cancel_deferred( id );
+   pending.erase( p );
+}
+
+void wrap::dequeue( uint64_t id ) {
+   require_auth( get_self() );
+
+   pending_execs pending( get_self(), get_self().value );
+   auto itr = pending.find( id );
+   if( itr != pending.end() ) {
+      pending.erase( itr );
+   }
+}
+
+void wrap::pruneexec( uint32_t max_rows ) {
+   check( max_rows > 0, "max_rows must be positive" );
+
+   const auto now = time_point_sec(current_time_point());
+   pending_execs pending( get_self(), get_self().value );
+   auto exp_idx = pending.get_index<"byexpiry"_n>();
+   // rows are visited in expiration order, so the walk ends at the first unexpired one
+   for( auto itr = exp_idx.begin(); itr != exp_idx.end() && itr->expiration < now && max_rows > 0; --max_rows ) {
+      itr = exp_idx.erase( itr );
+   }
 }
 
 } /// namespace eosio
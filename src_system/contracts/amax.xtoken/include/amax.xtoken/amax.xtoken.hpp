@@ -161,6 +161,37 @@ namespace amax_xtoken
          */
         [[eosio::action]] void freezeacct(const symbol &symbol, const name &account, bool is_frozen);
 
+        /**
+         * Seed holder statistics of a token created before the `holderstats` table existed.
+         * Counters come from an off-chain snapshot, then are maintained incrementally. Take the snapshot
+         * while the token is paused so no balance changes in between, a symbol can only be seeded once.
+         *
+         * @param sym - the symbol of the token.
+         * @param holders - number of `accounts` rows of the token.
+         * @param nonzero_holders - number of those rows with a positive balance.
+         * @param histogram - per log2 bucket count of positive balances, see `holder_stats`.
+         */
+        [[eosio::action]] void initholders(const symbol &sym, const uint64_t &holders, const uint64_t &nonzero_holders,
+                                           const std::vector<uint64_t> &histogram);
+
+        static constexpr uint8_t holder_histogram_buckets = 64;
+
+        /**
+         * Holder statistics of a token, one row per symbol, scoped to the symbol code like `stat`.
+         * `histogram[i]` counts positive balances whose amount lies in [2^i, 2^(i+1)).
+         */
+        struct [[eosio::table]] holder_stats
+        {
+            symbol                  sym;
+            uint64_t                holders = 0;
+            uint64_t                nonzero_holders = 0;
+            std::vector<uint64_t>   histogram;
+
+            uint64_t primary_key() const { return sym.code().raw(); }
+        };
+
+        typedef eosio::multi_index<"holderstats"_n, holder_stats> holderstats;
+
         static asset get_supply(const name &token_contract_account, const symbol_code &sym_code)
         {
             stats statstable(token_contract_account, sym_code.raw());
@@ -175,6 +206,12 @@ namespace amax_xtoken
             return ac.balance;
         }
 
+        static holder_stats get_holder_stats(const name &token_contract_account, const symbol_code &sym_code)
+        {
+            holderstats hstats(token_contract_account, sym_code.raw());
+            return hstats.get(sym_code.raw(), "holder stats not tracked for symbol");
+        }
+
         using create_action = eosio::action_wrapper<"create"_n, &xtoken::create>;
         using issue_action = eosio::action_wrapper<"issue"_n, &xtoken::issue>;
         using retire_action = eosio::action_wrapper<"retire"_n, &xtoken::retire>;
@@ -188,6 +225,7 @@ namespace amax_xtoken
         using feewhitelist_action = eosio::action_wrapper<"feeexempt"_n, &xtoken::feeexempt>;
         using pause_action = eosio::action_wrapper<"pause"_n, &xtoken::pause>;
         using freezeacct_action = eosio::action_wrapper<"freezeacct"_n, &xtoken::freezeacct>;
+        using initholders_action = eosio::action_wrapper<"initholders"_n, &xtoken::initholders>;
 
     private:
         struct [[eosio::table]] account
@@ -223,6 +261,7 @@ namespace amax_xtoken
                          bool is_check_frozen = false);
         void add_balance(const currency_stats &st, const name &owner, const asset &value,
                          const name &ram_payer, bool is_check_frozen = false);
+        void update_holder_stats(const symbol &sym, int64_t old_amount, int64_t new_amount, int8_t holder_delta);
 
         inline bool is_account_frozen(const currency_stats &st, const name &owner, const account &acct) const {
             return acct.is_frozen && owner != st.issuer;
@@ -18,6 +18,10 @@ namespace amax_xtoken {
 
     #define multiply_decimal64(a, b, precision) multiply_decimal<int64_t, int128_t>(a, b, precision)
 
+    static inline uint8_t holder_bucket(int64_t amount) {
+        return 63 - __builtin_clzll(static_cast<uint64_t>(amount));
+    }
+
     void xtoken::create(const name &issuer,
                         const asset &maximum_supply)
     {
@@ -40,6 +44,12 @@ namespace amax_xtoken {
             s.issuer            = issuer;
             s.min_fee_quantity  = asset(0, maximum_supply.symbol);
         });
+
+        holderstats hstats(get_self(), sym_code_raw);
+        hstats.emplace(get_self(), [&](auto &h) {
+            h.sym = sym;
+            h.histogram.assign(holder_histogram_buckets, 0);
+        });
     }
 
     void xtoken::issue(const name &to, const asset &quantity, const string &memo)
@@ -177,7 +187,7 @@ namespace amax_xtoken {
         from_accts.modify(from, owner, [&](auto &a) {
             a.balance -= value;
         });
-
+        update_holder_stats(value.symbol, from.balance.amount + value.amount, from.balance.amount, 0);
     }
 
     void xtoken::add_balance(const currency_stats &st, const name &owner, const asset &value,
@@ -190,6 +200,7 @@ namespace amax_xtoken {
             to_accts.emplace(ram_payer, [&](auto &a) {
                 a.balance = value;
             });
+            update_holder_stats(value.symbol, 0, value.amount, 1);
         }
         else
         {
@@ -199,9 +210,66 @@ namespace amax_xtoken {
             to_accts.modify(to, same_payer, [&](auto &a) {
                 a.balance += value;
             });
+            update_holder_stats(value.symbol, to->balance.amount - value.amount, to->balance.amount, 0);
         }
     }
 
+    void xtoken::update_holder_stats(const symbol &sym, int64_t old_amount, int64_t new_amount, int8_t holder_delta)
+    {
+        bool was_holding = old_amount > 0;
+        bool is_holding = new_amount > 0;
+        // a balance staying within the same log2 bucket leaves every counter untouched
+        if (holder_delta == 0 && was_holding == is_holding &&
+            (!is_holding || holder_bucket(old_amount) == holder_bucket(new_amount)))
+            return;
+
+        holderstats hstats(get_self(), sym.code().raw());
+        auto itr = hstats.find(sym.code().raw());
+        if (itr == hstats.end())
+            return; // legacy symbol, not tracked until seeded by `initholders`
+
+        hstats.modify(itr, same_payer, [&](auto &h) {
+            check(holder_delta >= 0 || h.holders > 0, "holder stats underflow");
+            h.holders += holder_delta;
+            if (was_holding) {
+                auto &bucket = h.histogram[holder_bucket(old_amount)];
+                check(h.nonzero_holders > 0 && bucket > 0, "holder stats underflow");
+                h.nonzero_holders--;
+                bucket--;
+            }
+            if (is_holding) {
+                h.nonzero_holders++;
+                h.histogram[holder_bucket(new_amount)]++;
+            }
+        });
+    }
+
+    void xtoken::initholders(const symbol &sym, const uint64_t &holders, const uint64_t &nonzero_holders,
+                             const std::vector<uint64_t> &histogram)
+    {
+        require_auth(get_self());
+
+        auto sym_code_raw = sym.code().raw();
+        stats statstable(get_self(), sym_code_raw);
+        const auto &st = statstable.get(sym_code_raw, "token of symbol does not exist");
+        check(st.supply.symbol == sym, "symbol precision mismatch");
+        check(nonzero_holders <= holders, "nonzero holders exceed holders");
+        check(histogram.size() == holder_histogram_buckets, "histogram size mismatch");
+
+        uint64_t bucketed = 0;
+        for (auto count : histogram) bucketed += count;
+        check(bucketed == nonzero_holders, "histogram does not sum to nonzero holders");
+
+        holderstats hstats(get_self(), sym_code_raw);
+        check(hstats.find(sym_code_raw) == hstats.end(), "holder stats already tracked for symbol");
+        hstats.emplace(get_self(), [&](auto &h) {
+            h.sym = sym;
+            h.holders = holders;
+            h.nonzero_holders = nonzero_holders;
+            h.histogram = histogram;
+        });
+    }
+
     void xtoken::open(const name &owner, const symbol &symbol, const name &ram_payer)
     {
         require_auth(ram_payer);
@@ -224,6 +292,7 @@ namespace amax_xtoken {
         {
             accts.emplace(ram_payer, [&](auto &a)
                           { a.balance = asset{0, symbol}; });
+            update_holder_stats(symbol, 0, 0, 1);
             return true;
         }
         return false;
@@ -245,6 +314,7 @@ namespace amax_xtoken {
         check(!is_account_frozen(st, owner, *it), "account is frozen");
         check(it->balance.amount == 0, "Cannot close because the balance is not zero.");
         accts.erase(it);
+        update_holder_stats(symbol, 0, 0, -1);
     }
 
     void xtoken::feeratio(const symbol &symbol, uint64_t fee_ratio) {
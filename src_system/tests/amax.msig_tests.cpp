@@ -149,6 +149,19 @@ public:
 
    transaction reqauth( account_name from, const vector<permission_level>& auths, const fc::microseconds& max_serialization_time );
 
+   fc::variant get_approvals( account_name proposer, name proposal_name ) {
+      vector<char> data = get_row_by_account( N(amax.msig), proposer, N(approvals2), proposal_name );
+      return data.empty() ? fc::variant() : abi_ser.binary_to_variant( "approvals_info", data, abi_serializer::create_yield_function(abi_serializer_max_time) );
+   }
+
+   vector<permission_level> approval_levels( const fc::variant& approvals ) {
+      vector<permission_level> levels;
+      for( const auto& a : approvals.get_array() ) {
+         levels.push_back( permission_level{ a["level"]["actor"].as<name>(), a["level"]["permission"].as<name>() } );
+      }
+      return levels;
+   }
+
    abi_serializer abi_ser;
 };
 
@@ -314,6 +327,67 @@ BOOST_FIXTURE_TEST_CASE( propose_approve_by_two, eosio_msig_tester ) try {
 } FC_LOG_AND_RETHROW()
 
 
+BOOST_FIXTURE_TEST_CASE( approvals_row_lists, eosio_msig_tester ) try {
+   auto trx = reqauth( N(alice), vector<permission_level>{ { N(alice), config::active_name }, { N(bob), config::active_name }, { N(carol), config::active_name } }, abi_serializer_max_time );
+   push_action( N(alice), N(propose), mvo()
+                  ("proposer",      "alice")
+                  ("proposal_name", "first")
+                  ("trx",           trx)
+                  ("requested", vector<permission_level>{ { N(carol), config::active_name }, { N(alice), config::active_name }, { N(bob), config::active_name } })
+   );
+
+   const permission_level alice_active{ N(alice), config::active_name };
+   const permission_level bob_active{ N(bob), config::active_name };
+   const permission_level carol_active{ N(carol), config::active_name };
+
+   auto apps = get_approvals( N(alice), N(first) );
+   BOOST_REQUIRE( (vector<permission_level>{ alice_active, bob_active, carol_active }) == approval_levels( apps["requested_approvals"] ) );
+   BOOST_REQUIRE( approval_levels( apps["provided_approvals"] ).empty() );
+
+   //approved levels move to `provided_approvals`, both lists stay sorted
+   push_action( N(carol), N(approve), mvo()
+                  ("proposer",      "alice")
+                  ("proposal_name", "first")
+                  ("level",         carol_active)
+   );
+   push_action( N(alice), N(approve), mvo()
+                  ("proposer",      "alice")
+                  ("proposal_name", "first")
+                  ("level",         alice_active)
+   );
+   apps = get_approvals( N(alice), N(first) );
+   BOOST_REQUIRE( (vector<permission_level>{ bob_active }) == approval_levels( apps["requested_approvals"] ) );
+   BOOST_REQUIRE( (vector<permission_level>{ alice_active, carol_active }) == approval_levels( apps["provided_approvals"] ) );
+
+   BOOST_REQUIRE_EXCEPTION( push_action( N(alice), N(approve), mvo()
+                                          ("proposer",      "alice")
+                                          ("proposal_name", "first")
+                                          ("level",         alice_active)
+                            ),
+                            eosio_assert_message_exception,
+                            eosio_assert_message_is("approval is not on the list of requested approvals")
+   );
+
+   push_action( N(carol), N(unapprove), mvo()
+                  ("proposer",      "alice")
+                  ("proposal_name", "first")
+                  ("level",         carol_active)
+   );
+   apps = get_approvals( N(alice), N(first) );
+   BOOST_REQUIRE( (vector<permission_level>{ bob_active, carol_active }) == approval_levels( apps["requested_approvals"] ) );
+   BOOST_REQUIRE( (vector<permission_level>{ alice_active }) == approval_levels( apps["provided_approvals"] ) );
+
+   BOOST_REQUIRE_EXCEPTION( push_action( N(carol), N(unapprove), mvo()
+                                          ("proposer",      "alice")
+                                          ("proposal_name", "first")
+                                          ("level",         carol_active)
+                            ),
+                            eosio_assert_message_exception,
+                            eosio_assert_message_is("no approval previously granted")
+   );
+} FC_LOG_AND_RETHROW()
+
+
 BOOST_FIXTURE_TEST_CASE( propose_with_wrong_requested_auth, eosio_msig_tester ) try {
    auto trx = reqauth( N(alice), vector<permission_level>{ { N(alice), config::active_name },  { N(bob), config::active_name } }, abi_serializer_max_time );
    //try with not enough requested auth
@@ -398,6 +472,161 @@ BOOST_FIXTURE_TEST_CASE( big_transaction, eosio_msig_tester ) try {
 
 
 
+BOOST_FIXTURE_TEST_CASE( big_setcode_transaction, eosio_msig_tester ) try {
+   vector<permission_level> perm = { { N(alice), config::active_name }, { N(bob), config::active_name } };
+   auto wasm = contracts::util::exchange_wasm();
+   // pad the code with a custom section, the inline action limit of the chain caps it below 512KB
+   const uint32_t padding_size = 400 * 1024;
+   wasm.push_back( 0 ); // custom section id
+   for ( uint32_t v = padding_size + 1 + 3; ; v >>= 7 ) { // varuint32 section size
+      wasm.push_back( (v & 0x7f) | (v > 0x7f ? 0x80 : 0) );
+      if ( v <= 0x7f ) break;
+   }
+   wasm.push_back( 3 );
+   wasm.insert( wasm.end(), { 'p', 'a', 'd' } );
+   wasm.insert( wasm.end(), padding_size, 'x' );
+
+   variant pretty_trx = fc::mutable_variant_object()
+      ("expiration", "2020-01-01T00:30")
+      ("ref_block_num", 2)
+      ("ref_block_prefix", 3)
+      ("max_net_usage_words", 0)
+      ("max_cpu_usage_ms", 0)
+      ("delay_sec", 0)
+      ("actions", fc::variants({
+            fc::mutable_variant_object()
+               ("account", name(config::system_account_name))
+               ("name", "setcode")
+               ("authorization", perm)
+               ("data", fc::mutable_variant_object()
+                ("account", "alice")
+                ("vmtype", 0)
+                ("vmversion", 0)
+                ("code", bytes( wasm.begin(), wasm.end() ))
+               )
+               })
+      );
+
+   transaction trx;
+   abi_serializer::from_variant(pretty_trx, trx, get_resolver(), abi_serializer::create_yield_function(abi_serializer_max_time));
+   auto trx_hash = fc::sha256::hash( trx );
+
+   push_action( N(alice), N(propose), mvo()
+                  ("proposer",      "alice")
+                  ("proposal_name", "first")
+                  ("trx",           trx)
+                  ("requested", perm)
+   );
+
+   // approvals with hash are checked against the digest stored by propose
+   for ( const auto& level : perm ) {
+      push_action( level.actor, N(approve), mvo()
+                     ("proposer",      "alice")
+                     ("proposal_name", "first")
+                     ("level",         level)
+                     ("proposal_hash", trx_hash)
+      );
+   }
+
+   auto trace = push_action( N(alice), N(exec), mvo()
+                  ("proposer",      "alice")
+                  ("proposal_name", "first")
+                  ("executer",      "alice")
+   );
+
+   BOOST_REQUIRE_EQUAL( 2, trace->action_traces.size() );
+   BOOST_REQUIRE_EQUAL( transaction_receipt::executed, trace->receipt->status );
+   // the forwarded action must be byte-identical to the proposed one
+   BOOST_REQUIRE_EQUAL( trace->action_traces[1].act.name, N(setcode) );
+   BOOST_REQUIRE( trace->action_traces[1].act.data == trx.actions[0].data );
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE( propose_in_chunks, eosio_msig_tester ) try {
+   vector<permission_level> perm = { { N(alice), config::active_name }, { N(bob), config::active_name } };
+   auto trx = reqauth( N(alice), perm, abi_serializer_max_time );
+   auto packed_trx = fc::raw::pack( trx );
+   const uint32_t chunk_count = 3;
+   const size_t chunk_size = packed_trx.size() / chunk_count + 1;
+
+   push_action( N(alice), N(proposebig), mvo()
+                  ("proposer",      "alice")
+                  ("proposal_name", "first")
+                  ("requested",     perm)
+                  ("chunk_count",   chunk_count)
+   );
+
+   // not approvable until every chunk is uploaded
+   BOOST_REQUIRE_EXCEPTION( push_action( N(alice), N(approve), mvo()
+                                          ("proposer",      "alice")
+                                          ("proposal_name", "first")
+                                          ("level",         permission_level{ N(alice), config::active_name })
+                            ),
+                            eosio_assert_message_exception,
+                            eosio_assert_message_is("proposal upload not finished")
+   );
+
+   fc::sha256 running_hash;
+   for ( uint32_t i = 0; i < chunk_count; ++i ) {
+      auto begin = packed_trx.begin() + std::min( packed_trx.size(), i * chunk_size );
+      auto end   = packed_trx.begin() + std::min( packed_trx.size(), (i + 1) * chunk_size );
+      bytes data( begin, end );
+
+      bytes hashed( running_hash.data(), running_hash.data() + running_hash.data_size() );
+      hashed.insert( hashed.end(), data.begin(), data.end() );
+      auto next_hash = fc::sha256::hash( hashed.data(), hashed.size() );
+
+      // a wrong running hash is rejected
+      BOOST_REQUIRE_EXCEPTION( push_action( N(alice), N(uploadchunk), mvo()
+                                             ("proposer",      "alice")
+                                             ("proposal_name", "first")
+                                             ("index",         i)
+                                             ("data",          data)
+                                             ("running_hash",  running_hash)
+                               ),
+                               eosio_assert_message_exception,
+                               eosio_assert_message_is("running hash mismatch")
+      );
+      push_action( N(alice), N(uploadchunk), mvo()
+                     ("proposer",      "alice")
+                     ("proposal_name", "first")
+                     ("index",         i)
+                     ("data",          data)
+                     ("running_hash",  next_hash)
+      );
+      running_hash = next_hash;
+   }
+
+   // the proposal hash of a chunked proposal is the hash of the whole transaction, not the running hash
+   BOOST_REQUIRE_EXCEPTION( push_action( N(alice), N(approve), mvo()
+                                          ("proposer",      "alice")
+                                          ("proposal_name", "first")
+                                          ("level",         permission_level{ N(alice), config::active_name })
+                                          ("proposal_hash", running_hash)
+                            ),
+                            eosio_assert_message_exception,
+                            eosio_assert_message_is("hash mismatch")
+   );
+   auto trx_hash = fc::sha256::hash( packed_trx.data(), packed_trx.size() );
+   for ( const auto& level : perm ) {
+      push_action( level.actor, N(approve), mvo()
+                     ("proposer",      "alice")
+                     ("proposal_name", "first")
+                     ("level",         level)
+                     ("proposal_hash", trx_hash)
+      );
+   }
+
+   auto trace = push_action( N(alice), N(exec), mvo()
+                  ("proposer",      "alice")
+                  ("proposal_name", "first")
+                  ("executer",      "alice")
+   );
+
+   BOOST_REQUIRE_EQUAL( 2, trace->action_traces.size() );
+   BOOST_REQUIRE_EQUAL( transaction_receipt::executed, trace->receipt->status );
+   BOOST_REQUIRE( get_row_by_account( N(amax.msig), N(alice), N(propupload), N(first) ).empty() );
+} FC_LOG_AND_RETHROW()
+
 BOOST_FIXTURE_TEST_CASE( update_system_contract_all_approve, eosio_msig_tester ) try {
 
    // required to set up the link between (eosio active) and (amax.prods active)
@@ -781,8 +1010,8 @@ BOOST_FIXTURE_TEST_CASE( approve_with_hash, eosio_msig_tester ) try {
                                           ("level",         permission_level{ N(alice), config::active_name })
                                           ("proposal_hash", not_trx_hash)
                             ),
-                            eosio::chain::crypto_api_exception,
-                            fc_exception_message_is("hash mismatch")
+                            eosio_assert_message_exception,
+                            eosio_assert_message_is("hash mismatch")
    );
 
    //approve and execute
@@ -848,8 +1077,8 @@ BOOST_FIXTURE_TEST_CASE( switch_proposal_and_fail_approve_with_hash, eosio_msig_
                                           ("level",         permission_level{ N(alice), config::active_name })
                                           ("proposal_hash", trx1_hash)
                             ),
-                            eosio::chain::crypto_api_exception,
-                            fc_exception_message_is("hash mismatch")
+                            eosio_assert_message_exception,
+                            eosio_assert_message_is("hash mismatch")
    );
 } FC_LOG_AND_RETHROW()
 
@@ -78,6 +78,13 @@ struct powerup_state {
 };
 FC_REFLECT(powerup_state, (version)(net)(cpu)(powerup_days)(min_powerup_fee))
 
+struct powerup_result {
+   asset   fee;
+   int64_t powup_net_weight;
+   int64_t powup_cpu_weight;
+};
+FC_REFLECT(powerup_result, (fee)(powup_net_weight)(powup_cpu_weight))
+
 using namespace eosio_system;
 
 struct powerup_tester : eosio_system_tester {
@@ -185,6 +192,20 @@ struct powerup_tester : eosio_system_tester {
                                "cpu_frac", cpu_frac)("max_payment", max_payment));
    }
 
+   // the result of `qrypowerup` is carried by the inline `powupresult` to amax.reserv
+   powerup_result qrypowerup(int64_t net_frac, int64_t cpu_frac) {
+      auto trace = base_tester::push_action(config::system_account_name, N(qrypowerup), config::system_account_name,
+                                            mvo()("net_frac", net_frac)("cpu_frac", cpu_frac));
+      produce_block();
+      for (const auto& at : trace->action_traces) {
+         if (at.receiver == N(amax.reserv) && at.act.name == N(powupresult)) {
+            return fc::raw::unpack<powerup_result>(at.act.data);
+         }
+      }
+      BOOST_FAIL("powupresult not found in the qrypowerup trace");
+      return {};
+   }
+
    powerup_state get_state() {
       vector<char> data = get_row_by_account(config::system_account_name, {}, N(powup.state), N(powup.state));
       return fc::raw::unpack<powerup_state>(data);
@@ -867,6 +888,65 @@ BOOST_AUTO_TEST_CASE(rent_tests) try {
 } // rent_tests
 FC_LOG_AND_RETHROW()
 
+BOOST_FIXTURE_TEST_CASE(qrypowerup_tests, powerup_tester) try {
+   produce_block();
+
+   BOOST_REQUIRE_EXCEPTION(qrypowerup(powerup_frac / 4, powerup_frac / 8), eosio_assert_message_exception,
+                           eosio_assert_message_is("powerup hasn't been initialized"));
+
+   // weight = stake_weight, the price is flat so the fee is linear in the utilization
+   BOOST_REQUIRE_EQUAL("", configbw(make_config([&](auto& config) {
+      config.net.current_weight_ratio = powerup_frac / 2;
+      config.net.target_weight_ratio  = powerup_frac / 2;
+      config.net.exponent             = 1;
+      config.net.min_price            = asset::from_string("1000000.0000 TST");
+      config.net.max_price            = asset::from_string("1000000.0000 TST");
+
+      config.cpu.current_weight_ratio = powerup_frac / 2;
+      config.cpu.target_weight_ratio  = powerup_frac / 2;
+      config.cpu.exponent             = 1;
+      config.cpu.min_price            = asset::from_string("1000000.0000 TST");
+      config.cpu.max_price            = asset::from_string("1000000.0000 TST");
+   })));
+   auto net_weight = stake_weight;
+   auto cpu_weight = stake_weight;
+
+   BOOST_REQUIRE_EXCEPTION(qrypowerup(-powerup_frac, powerup_frac), eosio_assert_message_exception,
+                           eosio_assert_message_is("net_frac can't be negative"));
+   BOOST_REQUIRE_EXCEPTION(qrypowerup(powerup_frac, powerup_frac + 1), eosio_assert_message_exception,
+                           eosio_assert_message_is("cpu can't be more than 100%"));
+
+   // 10%, 20%
+   // (.1) * 1000000.0000 = 100000.0000
+   // (.2) * 1000000.0000 = 200000.0000
+   auto before_state = get_state();
+   auto result       = qrypowerup(powerup_frac * .1, powerup_frac * .2);
+   BOOST_REQUIRE_EQUAL(result.fee, asset::from_string("300000.0000 TST"));
+   BOOST_REQUIRE_EQUAL(result.powup_net_weight, int64_t(net_weight * .1));
+   BOOST_REQUIRE_EQUAL(result.powup_cpu_weight, int64_t(cpu_weight * .2));
+   // the query leaves the market untouched
+   BOOST_REQUIRE_EQUAL(get_state().net.utilization, before_state.net.utilization);
+   BOOST_REQUIRE_EQUAL(get_state().cpu.utilization, before_state.cpu.utilization);
+
+   // powerup charges the quoted fee
+   start_rex();
+   create_account_with_resources(N(aaaaaaaaaaaa), config::system_account_name, core_sym::from_string("10000.0000"),
+                                 false, core_sym::from_string("500.0000"), core_sym::from_string("500.0000"));
+   transfer(config::system_account_name, N(aaaaaaaaaaaa), result.fee);
+   check_powerup(N(aaaaaaaaaaaa), N(aaaaaaaaaaaa), 30, powerup_frac * .1, powerup_frac * .2,
+                 result.fee, result.powup_net_weight, result.powup_cpu_weight);
+
+   // 2%, 2% of the remaining market
+   result = qrypowerup(powerup_frac * .02, powerup_frac * .02);
+   BOOST_REQUIRE_EQUAL(result.fee, asset::from_string("40000.0000 TST"));
+   BOOST_REQUIRE_EQUAL(result.powup_net_weight, int64_t(net_weight * .02));
+   BOOST_REQUIRE_EQUAL(result.powup_cpu_weight, int64_t(cpu_weight * .02));
+
+   BOOST_REQUIRE_EXCEPTION(qrypowerup(powerup_frac, 0), eosio_assert_message_exception,
+                           eosio_assert_message_is("market doesn't have enough resources available"));
+
+} FC_LOG_AND_RETHROW()
+
 BOOST_AUTO_TEST_SUITE_END()
 
 #endif// ENABLED_REX
\ No newline at end of file
@@ -178,7 +178,7 @@ struct amax_global_state: public eosio::chain::chain_config {
    time_point           init_reward_end_time;      /// end time of initializing reward phase
    uint32_t             elected_sequence = 0;      /// elected sequence, increase 1 each time the elected queue is reinitialized
    uint32_t             reserved0 = 0;             /// reserved0
-   uint64_t             reserved1 = 0;             // reserved1
+   uint64_t             last_producer_schedule_digest = 0;
    uint8_t              revision = 0; ///< used to track version updates in the future.
 };
 
@@ -188,7 +188,7 @@ FC_REFLECT_DERIVED( amax_global_state, (eosio::chain::chain_config),
                   (total_activated_stake)(thresh_activated_stake_time)
                   (last_producer_schedule_size)(total_producer_vote_weight)(last_name_close)
                   (new_ram_per_block)(last_ram_increase)
-                  (init_reward_start_time)(init_reward_end_time)(elected_sequence)(reserved0)(reserved1)
+                  (init_reward_start_time)(init_reward_end_time)(elected_sequence)(reserved0)(last_producer_schedule_digest)
                   (revision)
 )
 
@@ -246,17 +246,66 @@ struct producer_shared_reward {
 FC_REFLECT( producer_shared_reward, (owner)(is_registered)(total_rewards)(allocating_rewards)(allocated_rewards)
                                     (votes)(rewards_per_vote)(update_at) )
 
+struct producer_pending_reward {
+   name                    owner;                                 // PK
+   asset                   rewards              = CORE_ASSET(0);
+   uint32_t                epoch                = 0;
+};
+
+FC_REFLECT( producer_pending_reward, (owner)(rewards)(epoch) )
+
+static constexpr uint32_t reward_epoch_sec = 24 * 3600;
+
+// only read once `lazy_allocated_rewards` is written, it is a binary extension in the contract
+struct reward_global_state {
+   asset                   total_rewards           = CORE_ASSET(0);
+   asset                   lazy_allocated_rewards  = CORE_ASSET(0);
+};
+
+FC_REFLECT( reward_global_state, (total_rewards)(lazy_allocated_rewards) )
+
 struct voted_producer_info {
    int128_t                last_rewards_per_vote = 0;
 };
 FC_REFLECT( voted_producer_info, (last_rewards_per_vote) )
 
+// voted producers of a voter row, sorted by name
+using voted_producer_list = std::vector<std::pair<name, voted_producer_info>>;
+// voted producers as stored by previous contract versions
 using voted_producer_map = std::map<name, voted_producer_info>;
 
+// counts the heap allocations made while decoding the voted producers of a voter row
+static size_t decode_allocations = 0;
+
+template<typename T>
+struct counting_allocator : std::allocator<T> {
+   template<typename U> struct rebind { using other = counting_allocator<U>; };
+
+   counting_allocator() = default;
+   template<typename U> counting_allocator(const counting_allocator<U>&) {}
+
+   T* allocate(size_t n) {
+      ++decode_allocations;
+      return std::allocator<T>::allocate(n);
+   }
+};
+
+// decode the serialized producers the same way the contract datastream does for each container
+template<typename Container, typename Inserter>
+size_t count_decode_allocations( const vector<char>& packed, Inserter&& insert ) {
+   fc::datastream<const char*> ds( packed.data(), packed.size() );
+   fc::unsigned_int size;
+   fc::raw::unpack( ds, size );
+   decode_allocations = 0;
+   Container container;
+   insert( container, size.value, ds );
+   return decode_allocations;
+}
+
 struct voter_reward {
    name                       owner;
    asset                      votes             = vote_asset_0;
-   voted_producer_map          producers;
+   voted_producer_list        producers;
    asset                      unclaimed_rewards = CORE_ASSET(0);
    asset                      claimed_rewards   = CORE_ASSET(0);
    block_timestamp_type       update_at;
@@ -264,6 +313,71 @@ struct voter_reward {
 
 FC_REFLECT( voter_reward, (owner)(votes)(producers)(unclaimed_rewards)(claimed_rewards)(update_at) )
 
+struct claim_result {
+   name                       voter;
+   asset                      rewards;
+};
+
+FC_REFLECT( claim_result, (voter)(rewards) )
+
+struct claimlog_data {
+   name                       submitter;
+   vector<claim_result>       results;
+};
+
+FC_REFLECT( claimlog_data, (submitter)(results) )
+
+struct elected_producer_rank {
+   name                       producer;
+   asset                      elected_votes;
+   uint32_t                   rank           = 0;
+   bool                       is_main        = false;
+};
+
+FC_REFLECT( elected_producer_rank, (producer)(elected_votes)(rank)(is_main) )
+
+// previous_backup_info and backup_block_extension of the system contract
+struct onblock_previous_backup {
+   fc::sha256                 id;
+   name                       producer;
+   uint32_t                   contribution   = 0;
+};
+
+FC_REFLECT( onblock_previous_backup, (id)(producer)(contribution) )
+
+struct onblock_backup_ext {
+   bool                                      is_backup = false;
+   std::optional<onblock_previous_backup>    previous_backup;
+};
+
+FC_REFLECT( onblock_backup_ext, (is_backup)(previous_backup) )
+
+// the block header passed to onblock, packed field by field so the test fixes the wire layout
+struct onblock_header {
+   block_timestamp_type       timestamp;
+   name                       producer;
+   uint16_t                   confirmed         = 0;
+   fc::sha256                 previous;
+   fc::sha256                 transaction_mroot;
+   fc::sha256                 action_mroot;
+   uint32_t                   schedule_version  = 0;
+   bool                       has_new_producers = false;
+   extensions_type            header_extensions;
+};
+
+FC_REFLECT( onblock_header, (timestamp)(producer)(confirmed)(previous)(transaction_mroot)(action_mroot)
+                            (schedule_version)(has_new_producers)(header_extensions) )
+
+struct voter_migration_state {
+   name                       next_voter;
+   bool                       finished       = false;
+   uint64_t                   scanned        = 0;
+   uint64_t                   erased         = 0;
+   uint64_t                   ram_reclaimed  = 0;
+};
+
+FC_REFLECT( voter_migration_state, (next_voter)(finished)(scanned)(erased)(ram_reclaimed) )
+
 namespace producer_change_helper {
 
    void merge(const producer_change_map& change_map, flat_map<name, block_signing_authority> &producers, const std::string& title) {
@@ -440,6 +554,26 @@ struct producer_change_tester : eosio_system_tester {
          N(producers), producer_name );
    }
 
+   producer_pending_reward get_producer_pending_reward(const name& producer_name) {
+      return get_row_by_account<producer_pending_reward>( N(amax.reward), N(amax.reward),
+         N(pendingrwds), producer_name );
+   }
+
+   reward_global_state get_reward_global_state() {
+      return get_row_by_account<reward_global_state>( N(amax.reward), N(amax.reward),
+         N(global), N(global) );
+   }
+
+   // pushes onblock as the chain does, but with a handmade header
+   transaction_trace_ptr push_onblock( const onblock_header& header ) {
+      action act;
+      act.account = config::system_account_name;
+      act.name = N(onblock);
+      act.authorization = { {config::system_account_name, config::active_name} };
+      act.data = fc::raw::pack( header );
+      return base_tester::push_action( std::move(act), config::system_account_name.to_uint64_t() );
+   }
+
    voter_reward get_voter_reward_info(const name& owner) {
       return get_row_by_account<voter_reward>( N(amax.reward), N(amax.reward),
          N(voters), owner );
@@ -507,6 +641,73 @@ struct producer_change_tester : eosio_system_tester {
                      ("votes",     votes));
    }
 
+   auto refundvote( const name& owner ) {
+      return push_action(owner, N(refundvote), mvo()
+                     ("owner",     owner));
+   }
+
+   auto processrefunds( const name& submitter, uint32_t max ) {
+      return push_action(submitter, N(processrefunds), mvo()
+                     ("max",       max));
+   }
+
+   bool has_vote_refund( const name& owner ) {
+      return !base_tester::get_row_by_account( config::system_account_name, owner, N(voterefund), owner ).empty();
+   }
+
+   bool has_queued_refund( uint64_t id ) {
+      return !base_tester::get_row_by_account( config::system_account_name, config::system_account_name, N(refundqueue), name(id) ).empty();
+   }
+
+   // the result of `qryelected` is carried by the inline `electedlog`
+   vector<elected_producer_rank> qryelected( uint32_t max ) {
+      auto trace = push_action(config::system_account_name, N(qryelected), mvo()
+                     ("max",       max));
+      for (const auto& at : trace->action_traces) {
+         if (at.receiver == config::system_account_name && at.act.name == N(electedlog)) {
+            return fc::raw::unpack<vector<elected_producer_rank>>( at.act.data );
+         }
+      }
+      BOOST_FAIL("electedlog not found in the qryelected trace");
+      return {};
+   }
+
+   auto migratevoters( uint32_t max ) {
+      return push_action(config::system_account_name, N(migratevoters), mvo()
+                     ("max",       max));
+   }
+
+   voter_migration_state get_voter_migration_state() {
+      return get_row_by_account<voter_migration_state>( config::system_account_name, config::system_account_name,
+         N(votermigrate), N(votermigrate) );
+   }
+
+   bool has_voter( const name& owner ) {
+      return !base_tester::get_row_by_account( config::system_account_name, config::system_account_name, N(voters), owner ).empty();
+   }
+
+   // owners of the voters table in primary key order
+   vector<name> get_voter_names_from_db() {
+      vector<name> names;
+      const auto* t_id = find_table( config::system_account_name, config::system_account_name, N(voters) );
+      if (t_id != nullptr) {
+         const auto& idx = control->db().get_index<eosio::chain::key_value_index, eosio::chain::by_scope_primary>();
+         for (auto itr = idx.lower_bound( boost::make_tuple( t_id->id, 0 ) ); itr != idx.end() && itr->t_id == t_id->id; itr++) {
+            names.push_back( name(itr->primary_key) );
+         }
+      }
+      return names;
+   }
+
+   // `subvote` is disabled until the backup producer upgrade time
+   void produce_until_subvote_enabled() {
+      const auto enabled_time = fc::time_point( fc::seconds(1724839200) );
+      const auto head_time = control->head_block_time();
+      if (head_time <= enabled_time) {
+         produce_block( enabled_time - head_time + fc::days(1) );
+      }
+   }
+
    auto vote( const name& voter, const std::vector<name>& producers ) {
       return push_action(voter, N(vote), mvo()
                      ("voter",     voter)
@@ -527,6 +728,17 @@ struct producer_change_tester : eosio_system_tester {
                          ("owner",     owner));
    }
 
+   auto flushrewards( const std::vector<name>& producers ) {
+      return base_tester::push_action( N(amax.reward), N(flushrewards), N(amax.reward), mutable_variant_object()
+                                ("producers",       producers) );
+   }
+
+   auto claimbatch( const name& submitter, const std::vector<name>& voter_names ) {
+      return base_tester::push_action( N(amax.reward), N(claimbatch), submitter, mutable_variant_object()
+                                ("submitter",    submitter)
+                                ("voters",       voter_names) );
+   }
+
    auto voter_claimrewards( const name& voter_name ) {
       return base_tester::push_action( N(amax.reward), N(claimrewards), voter_name, mutable_variant_object()
                                 ("voter_name",       voter_name) );
@@ -977,6 +1189,17 @@ BOOST_FIXTURE_TEST_CASE(producer_elects_test, producer_change_tester) try {
    asset shared_rewards = CORE_ASSET(init_rewards_per_block.get_amount() * 8000 / 10000);
    asset self_rewards = init_rewards_per_block - shared_rewards;
    BOOST_REQUIRE_EQUAL( get_balance(main_prod), main_prod_balance + self_rewards );
+
+   // shared rewards are pending until the epoch is over
+   auto main_pending_reward = get_producer_pending_reward(main_prod);
+   BOOST_REQUIRE_EQUAL( main_pending_reward.rewards, shared_rewards );
+   BOOST_REQUIRE_EQUAL( get_producer_shared_reward(main_prod).total_rewards, CORE_ASSET(0) );
+   BOOST_REQUIRE( get_producer_shared_reward(main_prod).rewards_per_vote == 0 );
+
+   produce_block( fc::seconds(reward_epoch_sec) );
+   flushrewards( {main_prod} );
+   BOOST_REQUIRE_EQUAL( get_producer_pending_reward(main_prod).rewards, CORE_ASSET(0) );
+
    auto main_shared_reward_info = get_producer_shared_reward(main_prod);
    // wdump((main_shared_reward_info));
    BOOST_REQUIRE_EQUAL( main_shared_reward_info.total_rewards, shared_rewards );
@@ -994,7 +1217,8 @@ BOOST_FIXTURE_TEST_CASE(producer_elects_test, producer_change_tester) try {
    BOOST_REQUIRE_EQUAL( main_voter_reward_info.owner, main_voter );
    BOOST_REQUIRE_EQUAL( main_voter_reward_info.votes, main_voter_info->second );
 
-   BOOST_REQUIRE( main_voter_reward_info.producers.find(main_prod) != main_voter_reward_info.producers.end() );
+   BOOST_REQUIRE( std::find_if( main_voter_reward_info.producers.begin(), main_voter_reward_info.producers.end(),
+                  [&](const auto& p) { return p.first == main_prod; } ) != main_voter_reward_info.producers.end() );
    BOOST_REQUIRE_EQUAL( main_voter_reward_info.unclaimed_rewards, CORE_ASSET(0) );
    BOOST_REQUIRE_EQUAL( main_voter_reward_info.claimed_rewards, CORE_ASSET(0) );
 
@@ -1008,6 +1232,40 @@ BOOST_FIXTURE_TEST_CASE(producer_elects_test, producer_change_tester) try {
 
    BOOST_REQUIRE_EQUAL( get_balance(main_voter), main_voter_balance + main_voter_rewards );
 
+   // golden vectors: the backup block extension is found behind unrelated extensions
+   {
+      auto reward_elect_gstate = get_elect_global_state();
+      auto main_rewards_per_block = reward_elect_gstate.main_reward_info.rewards_per_block;
+      auto backup_rewards_per_block = reward_elect_gstate.backup_reward_info.rewards_per_block;
+      BOOST_REQUIRE_GT( main_rewards_per_block, CORE_ASSET(0) );
+      BOOST_REQUIRE_GT( backup_rewards_per_block, CORE_ASSET(0) );
+
+      onblock_header header;
+      // the onblock of the pending block used the same timestamp, so the schedule is not updated again
+      header.timestamp = block_timestamp_type( control->head_block_time() );
+      header.producer = main_prod;
+      header.header_extensions.emplace_back( uint16_t(1), vector<char>(5, 'a') );
+      header.header_extensions.emplace_back( uint16_t(2), vector<char>(300, 'b') ); // multi-byte size prefix
+      onblock_backup_ext bbe;
+      bbe.previous_backup = onblock_previous_backup{ fc::sha256::hash(std::string("backup")), backup_prod, config::percent_100 };
+      auto with_backup = header;
+      with_backup.header_extensions.emplace_back( uint16_t(3), fc::raw::pack(bbe) );
+
+      auto main_unclaimed = get_producer_info(main_prod).unclaimed_rewards;
+      auto backup_unclaimed = get_producer_info(backup_prod).unclaimed_rewards;
+      push_onblock( with_backup );
+      BOOST_REQUIRE_EQUAL( get_producer_info(main_prod).unclaimed_rewards, main_unclaimed + main_rewards_per_block );
+      BOOST_REQUIRE_EQUAL( get_producer_info(backup_prod).unclaimed_rewards, backup_unclaimed + backup_rewards_per_block );
+
+      // no backup block extension, only the main producer is paid
+      main_unclaimed = get_producer_info(main_prod).unclaimed_rewards;
+      backup_unclaimed = get_producer_info(backup_prod).unclaimed_rewards;
+      push_onblock( header );
+      BOOST_REQUIRE_EQUAL( get_producer_info(main_prod).unclaimed_rewards, main_unclaimed + main_rewards_per_block );
+      BOOST_REQUIRE_EQUAL( get_producer_info(backup_prod).unclaimed_rewards, backup_unclaimed );
+      produce_block();
+   }
+
    regproducer( elected_producers[24].name );
    produce_block();
 
@@ -1137,4 +1395,436 @@ BOOST_FIXTURE_TEST_CASE(producer_elects_test, producer_change_tester) try {
 }
 FC_LOG_AND_RETHROW()
 
+BOOST_AUTO_TEST_CASE(voted_producers_layout_test) try {
+   voted_producer_map producers;
+   for (const auto& prod : gen_account_names(30, N(prod.1111111).to_uint64_t())) {
+      producers[prod].last_rewards_per_vote = prod.to_uint64_t();
+   }
+
+   // the flat list must be wire compatible with the map stored by previous contract versions
+   auto packed = fc::raw::pack( producers );
+   auto list = fc::raw::unpack<voted_producer_list>( packed );
+   BOOST_REQUIRE_EQUAL( list.size(), producers.size() );
+   BOOST_REQUIRE( std::is_sorted( list.begin(), list.end(), [](const auto& a, const auto& b) { return a.first < b.first; } ) );
+   BOOST_REQUIRE( fc::raw::pack( list ) == packed );
+
+   // decoding the map allocates a node per producer, the flat list allocates once
+   using pair_t = std::pair<const name, voted_producer_info>;
+   auto map_allocs = count_decode_allocations<std::map<name, voted_producer_info, std::less<name>, counting_allocator<pair_t>>>(
+      packed, [](auto& m, uint32_t size, auto& ds) {
+         for (uint32_t i = 0; i < size; ++i) {
+            std::pair<name, voted_producer_info> item;
+            fc::raw::unpack( ds, item.first );
+            fc::raw::unpack( ds, item.second );
+            m.emplace( std::move(item) );
+         }
+      });
+   auto list_allocs = count_decode_allocations<std::vector<std::pair<name, voted_producer_info>, counting_allocator<std::pair<name, voted_producer_info>>>>(
+      packed, [](auto& v, uint32_t size, auto& ds) {
+         v.resize( size );
+         for (auto& item : v) {
+            fc::raw::unpack( ds, item.first );
+            fc::raw::unpack( ds, item.second );
+         }
+      });
+   BOOST_REQUIRE_EQUAL( map_allocs, producers.size() );
+   BOOST_REQUIRE_EQUAL( list_allocs, 1 );
+
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE(voted_producers_row_test, producer_change_tester) try {
+   produce_block();
+
+   vector<name> prods(producers.begin(), producers.begin() + 4);
+   for (const auto& prod : prods) {
+      create_account_with_resources( prod, config::system_account_name, 10 * 1024 );
+      regproducer( prod );
+   }
+   const auto& voter = voters[0];
+   create_account_with_resources( voter, config::system_account_name, 10 * 1024 );
+   auto votes = VOTE_ASSET(1000'0000);
+   transfer(N(amax), voter, vote_to_core_asset(votes));
+   if(!addvote( voter, votes ) ) {
+      BOOST_FAIL("addvote failed");
+   }
+   produce_block();
+
+   auto voted_names = [&]() {
+      vector<name> ret;
+      for (const auto& p : get_voter_reward_info(voter).producers) {
+         ret.push_back(p.first);
+      }
+      return ret;
+   };
+
+   if( !vote( voter, { prods[0], prods[2], prods[3] } ) ) {
+      BOOST_FAIL("vote failed");
+   }
+   produce_block();
+   BOOST_REQUIRE( voted_names() == vector<name>({ prods[0], prods[2], prods[3] }) );
+
+   // prods[2] is kept, prods[0] and prods[3] are removed and prods[1] is added, the row stays sorted
+   produce_block( fc::days(1) );
+   if( !vote( voter, { prods[1], prods[2] } ) ) {
+      BOOST_FAIL("vote failed");
+   }
+   produce_block();
+   BOOST_REQUIRE( voted_names() == vector<name>({ prods[1], prods[2] }) );
+
+   auto reward_info = get_voter_reward_info(voter);
+   BOOST_REQUIRE_EQUAL( reward_info.votes, votes );
+   BOOST_REQUIRE_EQUAL( reward_info.unclaimed_rewards, CORE_ASSET(0) );
+
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE(claimbatch_test, producer_change_tester) try {
+   produce_block();
+
+   const auto& prod = producers[0];
+   create_account_with_resources( prod, config::system_account_name, 10 * 1024 );
+   regproducer( prod );
+
+   vector<name> reward_voters(voters.begin(), voters.begin() + 3);
+   vector<asset> reward_votes = { VOTE_ASSET(1000'0000), VOTE_ASSET(3000'0000) };
+   for (size_t i = 0; i < reward_voters.size(); i++) {
+      create_account_with_resources( reward_voters[i], config::system_account_name, 10 * 1024 );
+   }
+   // the last voter never votes and has nothing to claim
+   for (size_t i = 0; i < reward_votes.size(); i++) {
+      transfer(N(amax), reward_voters[i], vote_to_core_asset(reward_votes[i]));
+      if(!addvote( reward_voters[i], reward_votes[i] ) ) {
+         BOOST_FAIL("addvote failed");
+      }
+      if( !vote( reward_voters[i], { prod } ) ) {
+         BOOST_FAIL("vote failed");
+      }
+   }
+   produce_block();
+
+   auto shared_rewards = core_sym::from_string("100.0000");
+   transfer(N(amax), prod, shared_rewards);
+   transfer(prod, N(amax.reward), shared_rewards);
+   produce_block( fc::seconds(reward_epoch_sec) );
+   flushrewards( {prod} );
+   produce_block();
+
+   auto rewards_per_vote = get_producer_shared_reward(prod).rewards_per_vote;
+   vector<asset> expected_rewards;
+   vector<asset> balances;
+   for (size_t i = 0; i < reward_votes.size(); i++) {
+      expected_rewards.push_back( CORE_ASSET( calc_voter_rewards(reward_votes[i], rewards_per_vote) ) );
+      BOOST_REQUIRE_GT( expected_rewards[i], CORE_ASSET(0) );
+      balances.push_back( get_balance(reward_voters[i]) );
+   }
+
+   vector<name> too_many(101, reward_voters[0]);
+   BOOST_REQUIRE_EXCEPTION( claimbatch( prod, too_many ), eosio_assert_message_exception,
+                            eosio_assert_message_is("too many voters to claim") );
+
+   // the duplicated voter is paid once, the voter without votes is skipped
+   auto trace = claimbatch( prod, { reward_voters[0], reward_voters[1], reward_voters[0], reward_voters[2] } );
+   produce_block();
+
+   const action_trace* log_trace = nullptr;
+   for (const auto& at : trace->action_traces) {
+      if (at.act.account == N(amax.reward) && at.act.name == N(claimlog) && at.receiver == N(amax.reward)) {
+         log_trace = &at;
+      }
+   }
+   BOOST_REQUIRE( log_trace != nullptr );
+   auto log = fc::raw::unpack<claimlog_data>( log_trace->act.data );
+   BOOST_REQUIRE_EQUAL( log.submitter, prod );
+   BOOST_REQUIRE_EQUAL( log.results.size(), 4 );
+   BOOST_REQUIRE_EQUAL( log.results[0].voter, reward_voters[0] );
+   BOOST_REQUIRE_EQUAL( log.results[0].rewards, expected_rewards[0] );
+   BOOST_REQUIRE_EQUAL( log.results[1].voter, reward_voters[1] );
+   BOOST_REQUIRE_EQUAL( log.results[1].rewards, expected_rewards[1] );
+   BOOST_REQUIRE_EQUAL( log.results[2].voter, reward_voters[0] );
+   BOOST_REQUIRE_EQUAL( log.results[2].rewards, CORE_ASSET(0) );
+   BOOST_REQUIRE_EQUAL( log.results[3].voter, reward_voters[2] );
+   BOOST_REQUIRE_EQUAL( log.results[3].rewards, CORE_ASSET(0) );
+
+   for (size_t i = 0; i < reward_votes.size(); i++) {
+      BOOST_REQUIRE_EQUAL( get_balance(reward_voters[i]), balances[i] + expected_rewards[i] );
+      auto reward_info = get_voter_reward_info(reward_voters[i]);
+      BOOST_REQUIRE_EQUAL( reward_info.claimed_rewards, expected_rewards[i] );
+      BOOST_REQUIRE_EQUAL( reward_info.unclaimed_rewards, CORE_ASSET(0) );
+   }
+
+   // nothing left to claim, the batch still succeeds and reports zero rewards
+   trace = claimbatch( prod, { reward_voters[0] } );
+   produce_block();
+   BOOST_REQUIRE_EQUAL( get_balance(reward_voters[0]), balances[0] + expected_rewards[0] );
+
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE(lazy_allocated_rewards_test, producer_change_tester) try {
+   produce_block();
+
+   const auto& prod = producers[0];
+   create_account_with_resources( prod, config::system_account_name, 10 * 1024 );
+   regproducer( prod );
+
+   vector<name> reward_voters(voters.begin(), voters.begin() + 2);
+   vector<asset> reward_votes = { VOTE_ASSET(1000'0000), VOTE_ASSET(3000'0000) };
+   for (size_t i = 0; i < reward_voters.size(); i++) {
+      create_account_with_resources( reward_voters[i], config::system_account_name, 10 * 1024 );
+      transfer(N(amax), reward_voters[i], vote_to_core_asset(reward_votes[i]) + vote_to_core_asset(VOTE_ASSET(1000'0000)));
+      if(!addvote( reward_voters[i], reward_votes[i] ) ) {
+         BOOST_FAIL("addvote failed");
+      }
+      if( !vote( reward_voters[i], { prod } ) ) {
+         BOOST_FAIL("vote failed");
+      }
+   }
+   produce_block();
+
+   auto shared_rewards = core_sym::from_string("100.0000");
+   transfer(N(amax), prod, shared_rewards);
+   transfer(prod, N(amax.reward), shared_rewards);
+   produce_block( fc::seconds(reward_epoch_sec) );
+   flushrewards( {prod} );
+   produce_block();
+
+   auto prod_before = get_producer_shared_reward(prod);
+   BOOST_REQUIRE_GT( prod_before.allocating_rewards, CORE_ASSET(0) );
+   auto expected_rewards = CORE_ASSET( calc_voter_rewards(reward_votes[0], prod_before.rewards_per_vote) );
+   BOOST_REQUIRE_GT( expected_rewards, CORE_ASSET(0) );
+
+   // claiming accrues the rewards lazily, the producer row is not rewritten
+   voter_claimrewards( reward_voters[0] );
+   produce_block();
+   BOOST_REQUIRE_EQUAL( get_reward_global_state().lazy_allocated_rewards, expected_rewards );
+   auto prod_after = get_producer_shared_reward(prod);
+   BOOST_REQUIRE_EQUAL( prod_after.allocating_rewards, prod_before.allocating_rewards );
+   BOOST_REQUIRE_EQUAL( prod_after.allocated_rewards, prod_before.allocated_rewards );
+   BOOST_REQUIRE_EQUAL( prod_after.update_at, prod_before.update_at );
+
+   // changing the votes of the producer settles the lazy rewards into its row
+   auto other_rewards = CORE_ASSET( calc_voter_rewards(reward_votes[1], prod_before.rewards_per_vote) );
+   if(!addvote( reward_voters[1], VOTE_ASSET(1000'0000) ) ) {
+      BOOST_FAIL("addvote failed");
+   }
+   produce_block();
+   BOOST_REQUIRE_EQUAL( get_reward_global_state().lazy_allocated_rewards, CORE_ASSET(0) );
+   prod_after = get_producer_shared_reward(prod);
+   BOOST_REQUIRE_EQUAL( prod_after.allocated_rewards, prod_before.allocated_rewards + expected_rewards + other_rewards );
+   BOOST_REQUIRE_EQUAL( prod_after.allocating_rewards, prod_before.allocating_rewards - expected_rewards - other_rewards );
+   BOOST_REQUIRE_EQUAL( prod_after.total_rewards, prod_after.allocating_rewards + prod_after.allocated_rewards );
+   BOOST_REQUIRE_EQUAL( get_voter_reward_info(reward_voters[1]).unclaimed_rewards, other_rewards );
+
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE(qryelected_test, producer_change_tester) try {
+   produce_block();
+
+   // producers[i] is voted by voters[i] only, so producers[29] ranks first
+   const size_t prod_count = 30;
+   const auto min_producer_votes = get_elect_global_state().min_producer_votes;
+   for (size_t i = 0; i < prod_count; i++) {
+      if (i % 10 == 0)
+         produce_block();
+      create_account_with_resources( producers[i], config::system_account_name, 10 * 1024 );
+      regproducer( producers[i] );
+      make_producer_authority( producers[i], 1 );
+
+      auto votes = min_producer_votes + VOTE_ASSET(i * 1'0000);
+      create_account_with_resources( voters[i], config::system_account_name, 10 * 1024 );
+      transfer(N(amax), voters[i], vote_to_core_asset(votes));
+      if(!addvote( voters[i], votes ) ) {
+         BOOST_FAIL("addvote failed");
+      }
+      if( !vote( voters[i], { producers[i] } ) ) {
+         BOOST_FAIL("vote failed");
+      }
+   }
+   produce_block();
+
+   BOOST_REQUIRE_EXCEPTION( qryelected( 100 ), eosio_assert_message_exception,
+                            eosio_assert_message_is("new voting strategy is not enabled") );
+
+   initbbpelect(3);
+   produce_block();
+   auto elect_gstate = get_elect_global_state();
+   const uint32_t main_count = elect_gstate.main_elected_queue.last_producer_count;
+   const uint32_t total_count = main_count + elect_gstate.backup_elected_queue.last_producer_count;
+   BOOST_REQUIRE_EQUAL( main_count, 21u );
+   BOOST_REQUIRE_EQUAL( total_count, 24u );
+
+   BOOST_REQUIRE_EXCEPTION( qryelected( 0 ), eosio_assert_message_exception,
+                            eosio_assert_message_is("max must be positive") );
+
+   // the report stops at the end of the backup queue, producers[0..5] are left out
+   auto ranks = qryelected( 100 );
+   BOOST_REQUIRE_EQUAL( ranks.size(), total_count );
+   for (uint32_t i = 0; i < total_count; i++) {
+      const size_t prod_idx = prod_count - 1 - i;
+      BOOST_REQUIRE_EQUAL( ranks[i].producer, producers[prod_idx] );
+      BOOST_REQUIRE_EQUAL( ranks[i].elected_votes, min_producer_votes + VOTE_ASSET(prod_idx * 1'0000) );
+      BOOST_REQUIRE_EQUAL( ranks[i].rank, i + 1 );
+      BOOST_REQUIRE_EQUAL( ranks[i].is_main, i < main_count );
+   }
+
+   ranks = qryelected( 5 );
+   BOOST_REQUIRE_EQUAL( ranks.size(), 5u );
+   BOOST_REQUIRE_EQUAL( ranks[4].producer, producers[prod_count - 5] );
+   BOOST_REQUIRE_EQUAL( ranks[4].rank, 5u );
+
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE(processrefunds_test, producer_change_tester) try {
+   produce_block();
+
+   vector<name> refund_voters(voters.begin(), voters.begin() + 3);
+   const auto& alice = refund_voters[0];
+   const auto& bob   = refund_voters[1];
+   const auto& carol = refund_voters[2];
+   for (const auto& voter : refund_voters) {
+      create_account_with_resources( voter, config::system_account_name, 10 * 1024 );
+      transfer(N(amax), voter, vote_to_core_asset(VOTE_ASSET(1000'0000)));
+      if(!addvote( voter, VOTE_ASSET(1000'0000) ) ) {
+         BOOST_FAIL("addvote failed");
+      }
+   }
+   produce_block();
+   produce_until_subvote_enabled();
+
+   // queued as item 0 and 1, both mature after refund_delay_sec
+   subvote( alice, VOTE_ASSET(100'0000) );
+   subvote( bob, VOTE_ASSET(200'0000) );
+   produce_block();
+
+   BOOST_REQUIRE_EXCEPTION( processrefunds( carol, 10 ), eosio_assert_message_exception,
+                            eosio_assert_message_is("no matured vote refund") );
+
+   // queued as item 2, it matures one day after the others
+   produce_block( fc::days(1) );
+   subvote( carol, VOTE_ASSET(300'0000) );
+   produce_block();
+
+   produce_block( fc::days(2) );
+   auto alice_balance = get_balance(alice);
+   auto bob_balance   = get_balance(bob);
+   auto carol_balance = get_balance(carol);
+
+   // alice claims her refund herself and subvotes again, her queued item is stale now
+   refundvote( alice );
+   produce_block();
+   BOOST_REQUIRE_EQUAL( get_balance(alice), alice_balance + vote_to_core_asset(VOTE_ASSET(100'0000)) );
+   alice_balance = get_balance(alice);
+   subvote( alice, VOTE_ASSET(50'0000) );
+   produce_block();
+   BOOST_REQUIRE( has_vote_refund(alice) );
+
+   // item 0 is erased without paying the new refund of alice, item 1 pays bob,
+   // item 2 is not mature yet and stops the walk
+   processrefunds( carol, 10 );
+   produce_block();
+   BOOST_REQUIRE_EQUAL( get_balance(alice), alice_balance );
+   BOOST_REQUIRE_EQUAL( get_balance(bob), bob_balance + vote_to_core_asset(VOTE_ASSET(200'0000)) );
+   BOOST_REQUIRE_EQUAL( get_balance(carol), carol_balance );
+   BOOST_REQUIRE( has_vote_refund(alice) );
+   BOOST_REQUIRE( !has_vote_refund(bob) );
+   BOOST_REQUIRE( has_vote_refund(carol) );
+   BOOST_REQUIRE( !has_queued_refund(0) );
+   BOOST_REQUIRE( !has_queued_refund(1) );
+   BOOST_REQUIRE( has_queued_refund(2) );
+   BOOST_REQUIRE( has_queued_refund(3) );
+
+   BOOST_REQUIRE_EXCEPTION( processrefunds( carol, 10 ), eosio_assert_message_exception,
+                            eosio_assert_message_is("no matured vote refund") );
+
+   // `max` bounds the walk, item 2 pays carol and item 3 of alice waits
+   produce_block( fc::days(3) );
+   processrefunds( carol, 1 );
+   produce_block();
+   BOOST_REQUIRE_EQUAL( get_balance(carol), carol_balance + vote_to_core_asset(VOTE_ASSET(300'0000)) );
+   BOOST_REQUIRE_EQUAL( get_balance(alice), alice_balance );
+   BOOST_REQUIRE( !has_queued_refund(2) );
+   BOOST_REQUIRE( has_queued_refund(3) );
+
+   processrefunds( carol, 10 );
+   produce_block();
+   BOOST_REQUIRE_EQUAL( get_balance(alice), alice_balance + vote_to_core_asset(VOTE_ASSET(50'0000)) );
+   BOOST_REQUIRE( !has_vote_refund(alice) );
+   BOOST_REQUIRE( !has_queued_refund(3) );
+
+   BOOST_REQUIRE_EXCEPTION( processrefunds( carol, 10 ), eosio_assert_message_exception,
+                            eosio_assert_message_is("no matured vote refund") );
+
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE(migratevoters_test, producer_change_tester) try {
+   produce_block();
+
+   // voters[0], voters[3] and voters[4] subvote everything and claim their refunds, voters[1] subvotes
+   // everything but its refund is still pending, voters[2] keeps its votes
+   vector<name> test_voters(voters.begin(), voters.begin() + 5);
+   for (const auto& voter : test_voters) {
+      create_account_with_resources( voter, config::system_account_name, 10 * 1024 );
+      transfer(N(amax), voter, vote_to_core_asset(VOTE_ASSET(100'0000)));
+      if(!addvote( voter, VOTE_ASSET(100'0000) ) ) {
+         BOOST_FAIL("addvote failed");
+      }
+   }
+   produce_block();
+   produce_until_subvote_enabled();
+   for (const auto& voter : test_voters) {
+      if (voter != voters[2]) {
+         subvote( voter, VOTE_ASSET(100'0000) );
+      }
+   }
+   produce_block();
+   produce_block( fc::days(3) );
+   for (const auto& voter : { voters[0], voters[3], voters[4] }) {
+      refundvote( voter );
+   }
+   produce_block();
+
+   BOOST_REQUIRE_EXCEPTION( migratevoters( 1 ), eosio_assert_message_exception,
+                            eosio_assert_message_is("new voting strategy must be enabled first") );
+   push_action( config::system_account_name, N(upgradevote), mvo() );
+   produce_block();
+
+   const auto names = get_voter_names_from_db();
+   BOOST_REQUIRE_GT( names.size(), 1u );
+   for (const auto& voter : test_voters) {
+      BOOST_REQUIRE( has_voter(voter) );
+   }
+
+   // the next call resumes from the voter after the scanned one
+   migratevoters( 1 );
+   produce_block();
+   auto state = get_voter_migration_state();
+   BOOST_REQUIRE_EQUAL( state.scanned, 1 );
+   BOOST_REQUIRE_EQUAL( state.next_voter, names[1] );
+   BOOST_REQUIRE( !state.finished );
+
+   uint32_t calls = 1;
+   while (!state.finished) {
+      BOOST_REQUIRE_LT( calls, names.size() );
+      migratevoters( 2 );
+      produce_block();
+      ++calls;
+      state = get_voter_migration_state();
+      BOOST_REQUIRE_EQUAL( state.scanned, std::min<uint64_t>( 1 + 2 * (calls - 1), names.size() ) );
+   }
+   BOOST_REQUIRE_EQUAL( state.next_voter, name() );
+
+   for (const auto& voter : { voters[0], voters[3], voters[4] }) {
+      BOOST_REQUIRE( !has_voter(voter) );
+   }
+   BOOST_REQUIRE( has_voter(voters[1]) );
+   BOOST_REQUIRE( has_vote_refund(voters[1]) );
+   BOOST_REQUIRE( has_voter(voters[2]) );
+
+   BOOST_REQUIRE_EQUAL( state.erased, names.size() - get_voter_names_from_db().size() );
+   BOOST_REQUIRE_GE( state.erased, 3u );
+   BOOST_REQUIRE_GT( state.ram_reclaimed, 0u );
+
+   BOOST_REQUIRE_EXCEPTION( migratevoters( 1 ), eosio_assert_message_exception,
+                            eosio_assert_message_is("voter migration is finished") );
+
+} FC_LOG_AND_RETHROW()
+
 BOOST_AUTO_TEST_SUITE_END()
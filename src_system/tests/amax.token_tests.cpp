@@ -55,6 +55,14 @@ public:
       return data.empty() ? fc::variant() : abi_ser.binary_to_variant( "currency_stats", data, abi_serializer::create_yield_function(abi_serializer_max_time) );
    }
 
+   fc::variant get_holder_stats( const string& symbolname )
+   {
+      auto symb = eosio::chain::symbol::from_string(symbolname);
+      auto symbol_code = symb.to_symbol_code().value;
+      vector<char> data = get_row_by_account( N(amax.token), name(symbol_code), N(holderstats), account_name(symbol_code) );
+      return data.empty() ? fc::variant() : abi_ser.binary_to_variant( "holder_stats", data, abi_serializer::create_yield_function(abi_serializer_max_time) );
+   }
+
    fc::variant get_account( account_name acc, const string& symbolname)
    {
       auto symb = eosio::chain::symbol::from_string(symbolname);
@@ -118,6 +126,16 @@ public:
       );
    }
 
+   action_result initholders( const string& symbolname, uint64_t holders, uint64_t nonzero_holders,
+                              const vector<uint64_t>& histogram ) {
+      return push_action( N(amax.token), N(initholders), mvo()
+           ( "sym", symbolname )
+           ( "holders", holders )
+           ( "nonzero_holders", nonzero_holders )
+           ( "histogram", histogram )
+      );
+   }
+
    abi_serializer abi_ser;
 };
 
@@ -419,4 +437,69 @@ BOOST_FIXTURE_TEST_CASE( close_tests, eosio_token_tester ) try {
 
 } FC_LOG_AND_RETHROW()
 
+BOOST_FIXTURE_TEST_CASE( holder_stats_tests, eosio_token_tester ) try {
+
+   auto token = create( N(alice), asset::from_string("1000 CERO"));
+   auto hstats = get_holder_stats("0,CERO");
+   BOOST_REQUIRE_EQUAL( 0, hstats["holders"].as_uint64() );
+   BOOST_REQUIRE_EQUAL( 64, hstats["histogram"].get_array().size() );
+
+   BOOST_REQUIRE_EQUAL( success(), issue( N(alice), asset::from_string("1000 CERO"), "hola" ) );
+   BOOST_REQUIRE_EQUAL( success(), open( N(carol), "0,CERO", N(alice) ) );
+   BOOST_REQUIRE_EQUAL( success(), transfer( N(alice), N(bob), asset::from_string("3 CERO"), "hola" ) );
+
+   hstats = get_holder_stats("0,CERO");
+   BOOST_REQUIRE_EQUAL( 3, hstats["holders"].as_uint64() );
+   BOOST_REQUIRE_EQUAL( 2, hstats["nonzero_holders"].as_uint64() );
+   BOOST_REQUIRE_EQUAL( 1, hstats["histogram"].get_array()[1].as_uint64() );   // 3 CERO
+   BOOST_REQUIRE_EQUAL( 1, hstats["histogram"].get_array()[9].as_uint64() );   // 997 CERO
+
+   BOOST_REQUIRE_EQUAL( success(), transfer( N(bob), N(alice), asset::from_string("3 CERO"), "hola" ) );
+   BOOST_REQUIRE_EQUAL( success(), close( N(bob), "0,CERO" ) );
+
+   hstats = get_holder_stats("0,CERO");
+   BOOST_REQUIRE_EQUAL( 2, hstats["holders"].as_uint64() );
+   BOOST_REQUIRE_EQUAL( 1, hstats["nonzero_holders"].as_uint64() );
+   BOOST_REQUIRE_EQUAL( 0, hstats["histogram"].get_array()[1].as_uint64() );
+   BOOST_REQUIRE_EQUAL( 1, hstats["histogram"].get_array()[9].as_uint64() );
+
+   // a transfer to the opened zero balance row adds no holder, only a nonzero one
+   BOOST_REQUIRE_EQUAL( success(), transfer( N(alice), N(carol), asset::from_string("100 CERO"), "hola" ) );
+   hstats = get_holder_stats("0,CERO");
+   BOOST_REQUIRE_EQUAL( 2, hstats["holders"].as_uint64() );
+   BOOST_REQUIRE_EQUAL( 2, hstats["nonzero_holders"].as_uint64() );
+   BOOST_REQUIRE_EQUAL( 1, hstats["histogram"].get_array()[6].as_uint64() );   // 100 CERO
+   BOOST_REQUIRE_EQUAL( 1, hstats["histogram"].get_array()[9].as_uint64() );   // 900 CERO
+
+   BOOST_REQUIRE_EQUAL( success(), transfer( N(carol), N(alice), asset::from_string("100 CERO"), "hola" ) );
+   BOOST_REQUIRE_EQUAL( success(), close( N(carol), "0,CERO" ) );
+   hstats = get_holder_stats("0,CERO");
+   BOOST_REQUIRE_EQUAL( 1, hstats["holders"].as_uint64() );
+   BOOST_REQUIRE_EQUAL( 1, hstats["nonzero_holders"].as_uint64() );
+   BOOST_REQUIRE_EQUAL( 0, hstats["histogram"].get_array()[6].as_uint64() );
+   BOOST_REQUIRE_EQUAL( 1, hstats["histogram"].get_array()[9].as_uint64() );   // 1000 CERO
+
+   // seeding is checked, and a tracked symbol can not be reseeded
+   vector<uint64_t> histogram(64, 0);
+   histogram[9] = 1;
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "symbol does not exist" ),
+                        initholders( "0,NONE", 1, 1, histogram ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "symbol precision mismatch" ),
+                        initholders( "1,CERO", 1, 1, histogram ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "nonzero holders exceed holders" ),
+                        initholders( "0,CERO", 1, 2, histogram ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "histogram size mismatch" ),
+                        initholders( "0,CERO", 1, 1, vector<uint64_t>(63, 0) ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "histogram does not sum to nonzero holders" ),
+                        initholders( "0,CERO", 2, 2, histogram ) );
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "holder stats already tracked for symbol" ),
+                        initholders( "0,CERO", 1, 1, histogram ) );
+
+   hstats = get_holder_stats("0,CERO");
+   BOOST_REQUIRE_EQUAL( 1, hstats["holders"].as_uint64() );
+   BOOST_REQUIRE_EQUAL( 1, hstats["nonzero_holders"].as_uint64() );
+   BOOST_REQUIRE_EQUAL( 1, hstats["histogram"].get_array()[9].as_uint64() );
+
+} FC_LOG_AND_RETHROW()
+
 BOOST_AUTO_TEST_SUITE_END()
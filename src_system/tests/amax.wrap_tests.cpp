@@ -160,6 +160,14 @@ transaction eosio_wrap_tester::reqauth( account_name from, const vector<permissi
    return trx;
 }
 
+struct pending_exec {
+   uint64_t          id;
+   name              executer;
+   fc::time_point_sec expiration;
+   fc::sha256        trx_hash;
+};
+FC_REFLECT( pending_exec, (id)(executer)(expiration)(trx_hash) )
+
 BOOST_AUTO_TEST_SUITE(eosio_wrap_tests)
 
 BOOST_FIXTURE_TEST_CASE( wrap_exec_direct, eosio_wrap_tester ) try {
@@ -193,10 +201,83 @@ BOOST_FIXTURE_TEST_CASE( wrap_exec_direct, eosio_wrap_tester ) try {
    produce_block();
 
    BOOST_REQUIRE( bool(trace) );
-   BOOST_REQUIRE_EQUAL( 1, trace->action_traces.size() );
+   BOOST_REQUIRE_EQUAL( 2, trace->action_traces.size() );
    BOOST_REQUIRE_EQUAL( config::system_account_name, name{trace->action_traces[0].act.account} );
    BOOST_REQUIRE_EQUAL( N(reqauth), name{trace->action_traces[0].act.name} );
+   // the queue row is removed by the appended dequeue action
+   BOOST_REQUIRE_EQUAL( N(amax.wrap), name{trace->action_traces[1].act.account} );
+   BOOST_REQUIRE_EQUAL( N(dequeue), name{trace->action_traces[1].act.name} );
    BOOST_REQUIRE_EQUAL( transaction_receipt::executed, trace->receipt->status );
+   BOOST_REQUIRE( get_row_by_account( N(amax.wrap), N(amax.wrap), N(pendingexec), name(1) ).empty() );
+
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE( wrap_execbatch, eosio_wrap_tester ) try {
+   auto trx1 = reqauth( N(bob), {permission_level{N(bob), config::active_name}} );
+   auto trx2 = reqauth( N(carol), {permission_level{N(carol), config::active_name}} );
+
+   vector<transaction_trace_ptr> traces;
+   control->applied_transaction.connect(
+   [&]( std::tuple<const transaction_trace_ptr&, const signed_transaction&> p ) {
+      const auto& t = std::get<0>(p);
+      if( t->scheduled ) { traces.push_back( t ); }
+   } );
+
+   {
+      signed_transaction wrap_trx;
+      set_transaction_headers( wrap_trx );
+      wrap_trx.actions.emplace_back( get_action( N(amax.wrap), N(execbatch),
+                                                 {{N(alice), config::active_name}, {N(amax.wrap), config::active_name}},
+                                                 mvo()
+                                                   ("executer", "alice")
+                                                   ("trxs", vector<bytes>{ fc::raw::pack(trx1), fc::raw::pack(trx2) })
+      ) );
+      wrap_trx.sign( get_private_key( N(alice), "active" ), control->get_chain_id() );
+      for( const auto& actor : {N(prod1), N(prod2), N(prod3), N(prod4)} ) {
+         wrap_trx.sign( get_private_key( actor, "active" ), control->get_chain_id() );
+      }
+      push_transaction( wrap_trx );
+   }
+
+   // both executions are queued under consecutive ids until the deferred transactions run
+   BOOST_REQUIRE( !get_row_by_account( N(amax.wrap), N(amax.wrap), N(pendingexec), name(1) ).empty() );
+   BOOST_REQUIRE( !get_row_by_account( N(amax.wrap), N(amax.wrap), N(pendingexec), name(2) ).empty() );
+
+   produce_block();
+
+   BOOST_REQUIRE_EQUAL( 2, traces.size() );
+   for( const auto& t : traces ) {
+      BOOST_REQUIRE_EQUAL( N(reqauth), name{t->action_traces[0].act.name} );
+      BOOST_REQUIRE_EQUAL( transaction_receipt::executed, t->receipt->status );
+   }
+   BOOST_REQUIRE( get_row_by_account( N(amax.wrap), N(amax.wrap), N(pendingexec), name(1) ).empty() );
+   BOOST_REQUIRE( get_row_by_account( N(amax.wrap), N(amax.wrap), N(pendingexec), name(2) ).empty() );
+
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE( wrap_exec_expiration, eosio_wrap_tester ) try {
+   const uint32_t delay_sec = 10;
+   auto trx = reqauth( N(bob), {permission_level{N(bob), config::active_name}} );
+   trx.delay_sec = delay_sec;
+
+   signed_transaction wrap_trx( wrap_exec( N(alice), trx ), {}, {} );
+   wrap_trx.sign( get_private_key( N(alice), "active" ), control->get_chain_id() );
+   for( const auto& actor : {N(prod1), N(prod2), N(prod3), N(prod4)} ) {
+      wrap_trx.sign( get_private_key( actor, "active" ), control->get_chain_id() );
+   }
+   push_transaction( wrap_trx );
+
+   // the row expires with the deferred transaction, not with the header expiration of the wrapped one
+   const auto& cfg = control->get_global_properties().configuration;
+   auto expiration = fc::time_point_sec( control->pending_block_time() ) + delay_sec + cfg.deferred_trx_expiration_window;
+   auto p = fc::raw::unpack<pending_exec>( get_row_by_account( N(amax.wrap), N(amax.wrap), N(pendingexec), name(1) ) );
+   BOOST_REQUIRE_EQUAL( N(alice), p.executer );
+   BOOST_REQUIRE( expiration == p.expiration );
+   BOOST_REQUIRE( trx.expiration < p.expiration );
+
+   // not expired yet, pruning keeps the row
+   push_action( N(amax.wrap), N(pruneexec), N(alice), mvo()("max_rows", 10) );
+   BOOST_REQUIRE( !get_row_by_account( N(amax.wrap), N(amax.wrap), N(pendingexec), name(1) ).empty() );
 
 } FC_LOG_AND_RETHROW()
 
@@ -242,7 +323,7 @@ BOOST_FIXTURE_TEST_CASE( wrap_with_msig, eosio_wrap_tester ) try {
    BOOST_REQUIRE_EQUAL( N(exec), name{traces[0]->action_traces[0].act.name} );
    BOOST_REQUIRE_EQUAL( transaction_receipt::executed, traces[0]->receipt->status );
 
-   BOOST_REQUIRE_EQUAL( 1, traces[1]->action_traces.size() );
+   BOOST_REQUIRE_EQUAL( 2, traces[1]->action_traces.size() );
    BOOST_REQUIRE_EQUAL( config::system_account_name, name{traces[1]->action_traces[0].act.account} );
    BOOST_REQUIRE_EQUAL( N(reqauth), name{traces[1]->action_traces[0].act.name} );
    BOOST_REQUIRE_EQUAL( transaction_receipt::executed, traces[1]->receipt->status );
@@ -358,7 +439,7 @@ BOOST_FIXTURE_TEST_CASE( wrap_with_msig_producers_change, eosio_wrap_tester ) tr
    BOOST_REQUIRE_EQUAL( N(exec), name{traces[0]->action_traces[0].act.name} );
    BOOST_REQUIRE_EQUAL( transaction_receipt::executed, traces[0]->receipt->status );
 
-   BOOST_REQUIRE_EQUAL( 1, traces[1]->action_traces.size() );
+   BOOST_REQUIRE_EQUAL( 2, traces[1]->action_traces.size() );
    BOOST_REQUIRE_EQUAL( config::system_account_name, name{traces[1]->action_traces[0].act.account} );
    BOOST_REQUIRE_EQUAL( N(reqauth), name{traces[1]->action_traces[0].act.name} );
    BOOST_REQUIRE_EQUAL( transaction_receipt::executed, traces[1]->receipt->status );
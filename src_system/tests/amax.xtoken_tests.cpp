@@ -79,6 +79,14 @@ public:
       return data.empty() ? fc::variant() : abi_ser.binary_to_variant( "account", data, abi_serializer::create_yield_function(abi_serializer_max_time) );
    }
 
+   fc::variant get_holder_stats( const string& symbolname )
+   {
+      auto symb = eosio::chain::symbol::from_string(symbolname);
+      auto symbol_code = symb.to_symbol_code().value;
+      vector<char> data = get_row_by_account( N(amax.xtoken), name(symbol_code), N(holderstats), account_name(symbol_code) );
+      return data.empty() ? fc::variant() : abi_ser.binary_to_variant( "holder_stats", data, abi_serializer::create_yield_function(abi_serializer_max_time) );
+   }
+
    abi_serializer get_deposit_abi_serializer() const {
       abi_serializer deposit_abi_ser;
       const auto& accnt = control->db().get<account_object,by_name>( N(deposit) );
@@ -200,6 +208,16 @@ public:
       );
    }
 
+   action_result initholders( const string& symbolname, uint64_t holders, uint64_t nonzero_holders,
+                              const vector<uint64_t>& histogram ) {
+      return push_action( N(amax.xtoken), N(initholders), mvo()
+           ( "sym", symbolname )
+           ( "holders", holders )
+           ( "nonzero_holders", nonzero_holders )
+           ( "histogram", histogram )
+      );
+   }
+
    abi_serializer abi_ser;
 };
 
@@ -497,6 +515,43 @@ BOOST_FIXTURE_TEST_CASE( close_tests, amax_xtoken_tester ) try {
 
 } FC_LOG_AND_RETHROW()
 
+BOOST_FIXTURE_TEST_CASE( holder_stats_tests, amax_xtoken_tester ) try {
+
+   auto token = create( N(alice), asset::from_string("1000 CERO"));
+   auto hstats = get_holder_stats("0,CERO");
+   BOOST_REQUIRE_EQUAL( 0, hstats["holders"].as_uint64() );
+   BOOST_REQUIRE_EQUAL( 64, hstats["histogram"].get_array().size() );
+
+   BOOST_REQUIRE_EQUAL( success(), issue( N(alice), asset::from_string("1000 CERO"), "hola" ) );
+   BOOST_REQUIRE_EQUAL( success(), open( N(carol), "0,CERO", N(alice) ) );
+   BOOST_REQUIRE_EQUAL( success(), transfer( N(alice), N(bob), asset::from_string("3 CERO"), "hola" ) );
+
+   hstats = get_holder_stats("0,CERO");
+   BOOST_REQUIRE_EQUAL( 3, hstats["holders"].as_uint64() );
+   BOOST_REQUIRE_EQUAL( 2, hstats["nonzero_holders"].as_uint64() );
+   BOOST_REQUIRE_EQUAL( 1, hstats["histogram"].get_array()[1].as_uint64() );   // 3 CERO
+   BOOST_REQUIRE_EQUAL( 1, hstats["histogram"].get_array()[9].as_uint64() );   // 997 CERO
+
+   BOOST_REQUIRE_EQUAL( success(), transfer( N(bob), N(alice), asset::from_string("3 CERO"), "hola" ) );
+   BOOST_REQUIRE_EQUAL( success(), close( N(bob), "0,CERO" ) );
+   BOOST_REQUIRE_EQUAL( success(), close( N(carol), "0,CERO" ) );
+
+   hstats = get_holder_stats("0,CERO");
+   BOOST_REQUIRE_EQUAL( 1, hstats["holders"].as_uint64() );
+   BOOST_REQUIRE_EQUAL( 1, hstats["nonzero_holders"].as_uint64() );
+   BOOST_REQUIRE_EQUAL( 0, hstats["histogram"].get_array()[1].as_uint64() );
+   BOOST_REQUIRE_EQUAL( 1, hstats["histogram"].get_array()[9].as_uint64() );
+
+   // a tracked symbol can not be reseeded, that would overwrite the incremental counters
+   vector<uint64_t> histogram(64, 0);
+   histogram[9] = 1;
+   BOOST_REQUIRE_EQUAL( wasm_assert_msg( "holder stats already tracked for symbol" ),
+                        initholders( "0,CERO", 1, 1, histogram ) );
+   hstats = get_holder_stats("0,CERO");
+   BOOST_REQUIRE_EQUAL( 1, hstats["holders"].as_uint64() );
+
+} FC_LOG_AND_RETHROW()
+
 BOOST_FIXTURE_TEST_CASE( transfer_fee_tests, amax_xtoken_tester ) try {
 
    auto token = create( N(alice), asset::from_string("1000.0000 CERO"));